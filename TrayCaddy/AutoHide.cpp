@@ -0,0 +1,144 @@
+#include "AutoHide.h"
+
+#include <cwchar>
+#include <cwctype>
+
+// --- Rules ---
+
+static std::wstring ToLower(const std::wstring& text) {
+    std::wstring lower(text);
+    for (auto& ch : lower) ch = (wchar_t)towlower(ch);
+    return lower;
+}
+
+bool ParseAutoHideRule(const std::wstring& key, const std::wstring& value, AUTO_HIDE_RULE* rule) {
+    // The settings parser keeps inline comments; a value is "10     ; comment" here
+    size_t len = value.find(L';');
+    if (len == std::wstring::npos) len = value.size();
+    while (len > 0 && (value[len - 1] == L' ' || value[len - 1] == L'\t')) len--;
+    if (len == 0) return false;
+    std::wstring text = value.substr(0, len);
+    wchar_t* end = nullptr;
+    unsigned long minutes = wcstoul(text.c_str(), &end, 10);
+    if (end == text.c_str() || *end != L'\0' || minutes > 7 * 24 * 60) return false;
+
+    AUTO_HIDE_RULE parsed;
+    parsed.idleMinutes = (unsigned)minutes;
+    std::wstring lower = ToLower(key);
+    if (lower == L"*") parsed.match = MATCH_ANY;
+    else if (lower.compare(0, 6, L"class:") == 0) { parsed.match = MATCH_CLASS; parsed.pattern = lower.substr(6); }
+    else if (lower.compare(0, 6, L"title:") == 0) { parsed.match = MATCH_TITLE; parsed.pattern = lower.substr(6); }
+    else return false;
+    if (parsed.match != MATCH_ANY && parsed.pattern.empty()) return false;
+
+    *rule = std::move(parsed);
+    return true;
+}
+
+std::vector<AUTO_HIDE_RULE> LoadAutoHideRules(const Settings& settings) {
+    std::vector<AUTO_HIDE_RULE> rules;
+    const SETTINGS_SECTION* section = settings.FindSection(L"AutoHide");
+    if (!section) return rules;
+    for (const auto& entry : section->entries) {
+        AUTO_HIDE_RULE rule;
+        if (ParseAutoHideRule(entry.key, entry.value, &rule)) rules.push_back(std::move(rule));
+    }
+    return rules;
+}
+
+unsigned MatchAutoHideRule(const std::vector<AUTO_HIDE_RULE>& rules, const std::wstring& className, const std::wstring& title) {
+    std::wstring lowerClass, lowerTitle;
+    for (const auto& rule : rules) {
+        switch (rule.match) {
+        case MATCH_ANY:
+            return rule.idleMinutes;
+        case MATCH_CLASS:
+            if (lowerClass.empty()) lowerClass = ToLower(className);
+            if (lowerClass == rule.pattern) return rule.idleMinutes;
+            break;
+        case MATCH_TITLE:
+            if (lowerTitle.empty()) lowerTitle = ToLower(title);
+            if (lowerTitle.find(rule.pattern) != std::wstring::npos) return rule.idleMinutes;
+            break;
+        }
+    }
+    return 0;
+}
+
+// --- Focus Tracker ---
+
+void FocusTracker::Arm(WINDOW_HANDLE window, TRACKED_WINDOW& item, uint64_t nowSec) {
+    if (item.timer) { wheel.Cancel(item.timer); item.timer = 0; }
+    if (window == foreground) return;
+
+    unsigned minutes = MatchAutoHideRule(rules, windows->GetWindowClass(window), windows->GetTitle(window));
+    if (minutes == 0) return;
+    // An empty wheel jumps straight to now, so the first timer is not filed against a stale tick
+    if (wheel.Count() == 0) wheel.Advance(nowSec, &expired);
+    item.timer = wheel.Schedule(item.idleSince + minutes * 60ull, window);
+}
+
+void FocusTracker::SetRules(std::vector<AUTO_HIDE_RULE> newRules, uint64_t nowSec) {
+    rules = std::move(newRules);
+    enabled = false;
+    for (const auto& rule : rules) if (rule.idleMinutes) enabled = true;
+    for (auto& [window, item] : tracked) Arm(window, item, nowSec);
+}
+
+void FocusTracker::Track(WINDOW_HANDLE window, uint64_t nowSec) {
+    if (!window || tracked.count(window)) return;
+    TRACKED_WINDOW& item = tracked[window];
+    item.idleSince = nowSec;
+    Arm(window, item, nowSec);
+}
+
+void FocusTracker::OnForeground(WINDOW_HANDLE window, uint64_t nowSec) {
+    if (window == foreground) return;
+    WINDOW_HANDLE previous = foreground;
+    foreground = window;
+
+    if (previous) {
+        TRACKED_WINDOW& item = tracked[previous];
+        item.idleSince = nowSec;
+        Arm(previous, item, nowSec);
+    }
+    if (window) {
+        TRACKED_WINDOW& item = tracked[window];
+        if (item.timer) { wheel.Cancel(item.timer); item.timer = 0; }
+    }
+}
+
+void FocusTracker::Forget(WINDOW_HANDLE window) {
+    auto it = tracked.find(window);
+    if (it == tracked.end()) return;
+    if (it->second.timer) wheel.Cancel(it->second.timer);
+    tracked.erase(it);
+    if (foreground == window) foreground = 0;
+}
+
+void FocusTracker::Clear() {
+    tracked.clear();
+    wheel = TimerWheel();
+    foreground = 0;
+}
+
+void FocusTracker::Collect(uint64_t nowSec, std::vector<WINDOW_HANDLE>* due) {
+    expired.clear();
+    wheel.Advance(nowSec, &expired);
+    for (const auto& timer : expired) {
+        WINDOW_HANDLE window = (WINDOW_HANDLE)timer.userData;
+        auto it = tracked.find(window);
+        if (it == tracked.end() || it->second.timer != timer.id) continue;
+        it->second.timer = 0;
+        if (!windows->IsValidWindow(window)) { tracked.erase(it); continue; }
+
+        // The title may have changed since the timer was armed (browser tabs, documents)
+        unsigned minutes = MatchAutoHideRule(rules, windows->GetWindowClass(window), windows->GetTitle(window));
+        if (minutes == 0) continue;
+        uint64_t dueAt = it->second.idleSince + minutes * 60ull;
+        if (dueAt > nowSec) { it->second.timer = wheel.Schedule(dueAt, window); continue; }
+
+        due->push_back(window);
+        tracked.erase(it);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Settings.h"
+#include "TimerWheel.h"
+#include "TrayCore.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// --- Auto-Hide ---
+// Parks windows that have not had focus for a while. Rules come from the
+// [AutoHide] section, one per line, first match wins:
+//
+//   [AutoHide]
+//   class:Notepad=10     ; window class, exact
+//   title:Slack=30       ; title contains
+//   *=60                 ; everything else
+//
+// Minutes of 0 exempt the matching windows. Without any rule nothing is hidden.
+// Anything after a ';' in the value is a comment, as shown.
+
+enum AUTO_HIDE_MATCH {
+    MATCH_ANY,
+    MATCH_CLASS,
+    MATCH_TITLE,
+};
+
+struct AUTO_HIDE_RULE {
+    AUTO_HIDE_MATCH match = MATCH_ANY;
+    std::wstring pattern; // Lowercase
+    unsigned idleMinutes = 0;
+};
+
+bool ParseAutoHideRule(const std::wstring& key, const std::wstring& value, AUTO_HIDE_RULE* rule);
+std::vector<AUTO_HIDE_RULE> LoadAutoHideRules(const Settings& settings);
+// Minutes for the first rule matching the window, 0 if none does.
+unsigned MatchAutoHideRule(const std::vector<AUTO_HIDE_RULE>& rules, const std::wstring& className, const std::wstring& title);
+
+// --- Focus Tracker ---
+// Keeps one timer per window that is not in the foreground, armed for the
+// moment it will have been idle for its rule's minutes. Only foreground
+// changes touch it, so there is no per-window SetTimer and no periodic scan;
+// the owner wakes up at NextDueTime and collects what came due.
+// Times are in seconds on any monotonic clock.
+
+class FocusTracker {
+public:
+    explicit FocusTracker(IWindowSystem* windows) : windows(windows) {}
+
+    // Re-arms every tracked window against the new rules, keeping its idle start.
+    void SetRules(std::vector<AUTO_HIDE_RULE> rules, uint64_t nowSec);
+    // False when no rule hides anything, so the caller can drop its hooks.
+    bool IsEnabled() const { return enabled; }
+
+    // Starts the idle clock for a background window (e.g. ones open at startup).
+    void Track(WINDOW_HANDLE window, uint64_t nowSec);
+    // window gained focus; the previous foreground window starts idling.
+    void OnForeground(WINDOW_HANDLE window, uint64_t nowSec);
+    void Forget(WINDOW_HANDLE window);
+    void Clear();
+
+    // Appends windows whose idle time ran out and stops tracking them.
+    void Collect(uint64_t nowSec, std::vector<WINDOW_HANDLE>* due);
+    // WHEEL_NO_TIMER when nothing is armed.
+    uint64_t NextDueTime() const { return wheel.NextTick(); }
+
+    size_t TrackedCount() const { return tracked.size(); }
+    size_t ArmedCount() const { return wheel.Count(); }
+
+private:
+    struct TRACKED_WINDOW {
+        uint64_t idleSince = 0;
+        TIMER_ID timer = 0; // 0 while focused or exempt
+    };
+
+    void Arm(WINDOW_HANDLE window, TRACKED_WINDOW& item, uint64_t nowSec);
+
+    IWindowSystem* windows;
+    std::vector<AUTO_HIDE_RULE> rules;
+    bool enabled = false;
+    TimerWheel wheel;
+    std::unordered_map<WINDOW_HANDLE, TRACKED_WINDOW> tracked;
+    WINDOW_HANDLE foreground = 0;
+    std::vector<TIMER_EXPIRY> expired; // Scratch for Collect
+};
@@ -0,0 +1,153 @@
+#include "EventTrace.h"
+
+#include <filesystem>
+#include <iterator>
+
+#define TRACE_MAGIC      "TCTR"
+#define TRACE_VERSION    2
+#define TRACE_HAS_CLASS  0x10
+#define TRACE_HAS_WINDOW 0x20
+#define TRACE_HAS_PARAMS 0x40
+#define TRACE_HAS_TEXT   0x80
+#define TRACE_TYPE_MASK  0x0F
+
+#define TRACE_FLUSH_BYTES (64 * 1024)
+
+// --- Encoding ---
+
+static void PutVarint(std::string* out, uint64_t value) {
+    while (value >= 0x80) {
+        out->push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out->push_back((char)value);
+}
+
+static void PutString(std::string* out, const std::wstring& text) {
+    PutVarint(out, text.size());
+    for (wchar_t ch : text) PutVarint(out, (uint16_t)ch);
+}
+
+static bool GetVarint(const std::string& data, size_t* pos, uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= data.size()) return false;
+        uint8_t byte = (uint8_t)data[(*pos)++];
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static bool GetString(const std::string& data, size_t* pos, std::wstring* text) {
+    uint64_t len, value;
+    if (!GetVarint(data, pos, &len) || len > data.size() - *pos) return false;
+    text->reserve((size_t)len);
+    for (uint64_t i = 0; i < len; i++) {
+        if (!GetVarint(data, pos, &value)) return false;
+        text->push_back((wchar_t)value);
+    }
+    return true;
+}
+
+void EncodeTraceEvent(const TRACE_EVENT& event, uint64_t previousUs, std::string* out) {
+    uint8_t flags = (uint8_t)event.type & TRACE_TYPE_MASK;
+    if (event.window) flags |= TRACE_HAS_WINDOW;
+    if (event.param || event.param2) flags |= TRACE_HAS_PARAMS;
+    if (!event.text.empty()) flags |= TRACE_HAS_TEXT;
+    if (!event.className.empty()) flags |= TRACE_HAS_CLASS;
+
+    out->push_back((char)flags);
+    PutVarint(out, event.timeUs >= previousUs ? event.timeUs - previousUs : 0);
+    if (flags & TRACE_HAS_WINDOW) PutVarint(out, event.window);
+    if (flags & TRACE_HAS_PARAMS) { PutVarint(out, event.param); PutVarint(out, event.param2); }
+    if (flags & TRACE_HAS_TEXT) PutString(out, event.text);
+    if (flags & TRACE_HAS_CLASS) PutString(out, event.className);
+}
+
+bool DecodeTrace(const std::string& data, std::vector<TRACE_EVENT>* events) {
+    events->clear();
+    const size_t headerLen = sizeof(TRACE_MAGIC) - 1;
+    if (data.size() < headerLen + 1 || data.compare(0, headerLen, TRACE_MAGIC) != 0) return false;
+    if ((uint8_t)data[headerLen] != TRACE_VERSION) return false;
+
+    size_t pos = headerLen + 1;
+    uint64_t timeUs = 0;
+    while (pos < data.size()) {
+        uint8_t flags = (uint8_t)data[pos++];
+        TRACE_EVENT event;
+        event.type = (TRACE_EVENT_TYPE)(flags & TRACE_TYPE_MASK);
+
+        uint64_t delta, value;
+        if (!GetVarint(data, &pos, &delta)) return false;
+        timeUs += delta;
+        event.timeUs = timeUs;
+        if (flags & TRACE_HAS_WINDOW) {
+            if (!GetVarint(data, &pos, &event.window)) return false;
+        }
+        if (flags & TRACE_HAS_PARAMS) {
+            if (!GetVarint(data, &pos, &value)) return false;
+            event.param = (uint32_t)value;
+            if (!GetVarint(data, &pos, &value)) return false;
+            event.param2 = (uint32_t)value;
+        }
+        if ((flags & TRACE_HAS_TEXT) && !GetString(data, &pos, &event.text)) return false;
+        if ((flags & TRACE_HAS_CLASS) && !GetString(data, &pos, &event.className)) return false;
+        events->push_back(std::move(event));
+    }
+    return true;
+}
+
+bool LoadTrace(const std::wstring& path, std::vector<TRACE_EVENT>* events) {
+    std::ifstream file(std::filesystem::path(path), std::ios::binary);
+    if (!file.is_open()) return false;
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return DecodeTrace(data, events);
+}
+
+// --- Recorder ---
+
+bool TraceRecorder::Open(const std::wstring& path) {
+    Close();
+    file.open(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    buffer.assign(TRACE_MAGIC);
+    buffer.push_back((char)TRACE_VERSION);
+    start = std::chrono::steady_clock::now();
+    lastUs = flushedUs = 0;
+    Flush(); // The header, so even an empty session leaves a loadable trace
+    return true;
+}
+
+void TraceRecorder::Record(TRACE_EVENT_TYPE type, uint64_t window, uint32_t param, uint32_t param2, const std::wstring& text,
+    const std::wstring& className) {
+    if (!file.is_open()) return;
+    TRACE_EVENT event;
+    event.type = type;
+    event.timeUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    event.window = window;
+    event.param = param;
+    event.param2 = param2;
+    event.text = text;
+    event.className = className;
+    EncodeTraceEvent(event, lastUs, &buffer);
+    lastUs = event.timeUs;
+
+    // Mouse moves over tray icons arrive in floods; only the double click restores
+    bool action = type != TRACE_WINDOW_CREATED && type != TRACE_WINDOW_DESTROYED && type != TRACE_WINDOW_TITLE &&
+        (type != TRACE_TRAY_ICON || param2 == TRACE_MOUSE_DBLCLK);
+    if (action || buffer.size() >= TRACE_FLUSH_BYTES || event.timeUs - flushedUs >= TRACE_FLUSH_MS * 1000ull) Flush();
+}
+
+void TraceRecorder::Flush() {
+    if (!file.is_open() || buffer.empty()) return;
+    file.write(buffer.data(), (std::streamsize)buffer.size());
+    file.flush();
+    buffer.clear();
+    flushedUs = lastUs;
+}
+
+void TraceRecorder::Close() {
+    Flush();
+    if (file.is_open()) file.close();
+}
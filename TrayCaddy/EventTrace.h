@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+
+// --- Event Traces ---
+// Compact binary record of the inputs that drive TrayCaddy, so a session
+// captured in the field can be replayed against the simulated backend
+// (TraceReplay.h, built with the tests and benchmarks only).
+//
+// File layout: "TCTR", version byte, then one record per event:
+//   flags/type byte   low 4 bits type, 0x10 class, 0x20 window, 0x40 params, 0x80 text
+//   delta time        LEB128 varint, microseconds since the previous event
+//   window            varint, if 0x20
+//   param, param2     varints, if 0x40
+//   text              varint length + one varint per UTF-16 unit, if 0x80
+//   class name        same encoding as text, if 0x10
+// Version 1 traces stored the hotkey id instead of the hide outcome and no
+// class names; they are rejected, since replaying them drifts.
+
+enum TRACE_EVENT_TYPE : uint8_t {
+    TRACE_HOTKEY = 1,        // WM_HOTKEY, after handling; window = foreground window, param = icon id it got (0 if not hidden), text = its title
+    TRACE_HIDE = 2,          // Window hidden at startup or by auto-hide; param = icon id, text = title
+    TRACE_TRAY_ICON = 3,     // WM_ICON; param = icon id, param2 = mouse message
+    TRACE_COMMAND = 4,       // WM_COMMAND; param = command id
+    TRACE_TASKBAR_CREATED = 5,
+    TRACE_WINDOW_CREATED = 6,  // text = title, className = window class
+    TRACE_WINDOW_DESTROYED = 7,
+    TRACE_WINDOW_TITLE = 8,    // text = new title
+    TRACE_RESTORE = 9,         // Restored from the hidden list, after handling; param = icon id
+};
+
+// Events that carry a window also carry its owning process id in param2, and
+// hotkey, hide and create events its class name.
+
+#define TRACE_MOUSE_DBLCLK 0x0203 // WM_LBUTTONDBLCLK
+
+struct TRACE_EVENT {
+    TRACE_EVENT_TYPE type = TRACE_HOTKEY;
+    uint64_t timeUs = 0; // Since the start of the trace
+    uint64_t window = 0;
+    uint32_t param = 0;
+    uint32_t param2 = 0;
+    std::wstring text;
+    std::wstring className;
+};
+
+#define TRACE_FLUSH_MS 1000 // Longest a recorded event waits in the buffer, given another event or a Flush call
+
+// Appends events to an in-memory buffer and writes it out in chunks. Hotkey,
+// hide, restore and other user actions are written out at once, so a crash or
+// kill keeps the tail of the session; window churn is batched for up to
+// TRACE_FLUSH_MS. Not thread safe; all recording happens on the UI thread.
+class TraceRecorder {
+public:
+    ~TraceRecorder() { Close(); }
+
+    bool Open(const std::wstring& path);
+    void Record(TRACE_EVENT_TYPE type, uint64_t window = 0, uint32_t param = 0, uint32_t param2 = 0, const std::wstring& text = std::wstring(),
+        const std::wstring& className = std::wstring());
+    void Flush(); // Writes out whatever is buffered; the owner calls it on a timer
+    void Close();
+    bool IsOpen() const { return file.is_open(); }
+
+private:
+    std::ofstream file;
+    std::string buffer;
+    std::chrono::steady_clock::time_point start;
+    uint64_t lastUs = 0;
+    uint64_t flushedUs = 0; // Time of the last flush
+};
+
+void EncodeTraceEvent(const TRACE_EVENT& event, uint64_t previousUs, std::string* out);
+bool DecodeTrace(const std::string& data, std::vector<TRACE_EVENT>* events);
+bool LoadTrace(const std::wstring& path, std::vector<TRACE_EVENT>* events);
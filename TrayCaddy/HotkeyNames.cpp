@@ -0,0 +1,150 @@
+#include "HotkeyNames.h"
+#include "Settings.h"
+
+#include <cwchar>
+#include <cwctype>
+
+// --- Key Name Table ---
+
+void KeyNameTable::EnsureLayout(IKeyboardLayout* layout) {
+    uintptr_t id = layout->GetLayoutId();
+    if (valid && id == layoutId) return;
+    for (unsigned vk = 0; vk < 256; vk++) {
+        names[vk][0] = L'\0';
+        if (vk != 0 && !layout->GetKeyName(vk, IsExtendedKey(vk), names[vk], KEY_NAME_MAX)) names[vk][0] = L'\0';
+        names[vk][KEY_NAME_MAX - 1] = L'\0';
+    }
+    layoutId = id;
+    valid = true;
+}
+
+const wchar_t* KeyNameTable::GetName(unsigned vk) const {
+    if (vk >= 256 || names[vk][0] == L'\0') return nullptr;
+    return names[vk];
+}
+
+static bool EqualsNoCase(const wchar_t* a, size_t aLen, const wchar_t* b) {
+    size_t i = 0;
+    for (; i < aLen; i++) {
+        if (b[i] == L'\0' || towlower(a[i]) != towlower(b[i])) return false;
+    }
+    return b[i] == L'\0';
+}
+
+unsigned KeyNameTable::FindKey(const wchar_t* name, size_t len) const {
+    if (len == 0) return 0;
+    for (unsigned vk = 1; vk < 256; vk++) {
+        if (names[vk][0] != L'\0' && EqualsNoCase(name, len, names[vk])) return vk;
+    }
+    return 0;
+}
+
+// --- Formatting ---
+
+size_t FormatHotkey(const KeyNameTable& table, unsigned modifiers, unsigned vk, wchar_t* buf, size_t bufLen) {
+    if (bufLen == 0) return 0;
+    size_t n = 0;
+    auto append = [&](const wchar_t* text) {
+        while (*text && n + 1 < bufLen) buf[n++] = *text++;
+    };
+
+    for (const auto& mod : MODIFIER_NAMES) {
+        if (modifiers & mod.flag) { append(mod.name); append(L" + "); }
+    }
+    if (vk != 0) {
+        const wchar_t* name = table.GetName(vk);
+        append(name ? name : L"Unknown");
+    }
+    else append(L"None");
+    buf[n] = L'\0';
+    return n;
+}
+
+// --- Parsing ---
+
+struct MODIFIER_ALIAS {
+    unsigned flag;
+    const wchar_t* name;
+};
+
+constexpr MODIFIER_ALIAS MODIFIER_ALIASES[] = {
+    { HK_MOD_WIN, L"Win" },
+    { HK_MOD_CONTROL, L"Ctrl" },
+    { HK_MOD_CONTROL, L"Control" },
+    { HK_MOD_SHIFT, L"Shift" },
+    { HK_MOD_ALT, L"Alt" },
+};
+
+static bool StartsWithNoCase(const wchar_t* text, const wchar_t* prefix) {
+    for (; *prefix; text++, prefix++) {
+        if (*text == L'\0' || towlower(*text) != towlower(*prefix)) return false;
+    }
+    return true;
+}
+
+static const wchar_t* SkipSpaces(const wchar_t* p) {
+    while (*p == L' ' || *p == L'\t') p++;
+    return p;
+}
+
+bool ParseHotkey(const KeyNameTable& table, const wchar_t* text, unsigned* modifiers, unsigned* vk) {
+    unsigned mods = 0;
+    const wchar_t* p = SkipSpaces(text);
+
+    // Peel "<modifier> +" prefixes; whatever is left is the key, which may itself contain '+'
+    bool matched = true;
+    while (matched) {
+        matched = false;
+        for (const auto& alias : MODIFIER_ALIASES) {
+            if (!StartsWithNoCase(p, alias.name)) continue;
+            const wchar_t* after = SkipSpaces(p + wcslen(alias.name));
+            if (*after != L'+') continue;
+            after = SkipSpaces(after + 1);
+            if (*after == L'\0') continue;
+            mods |= alias.flag;
+            p = after;
+            matched = true;
+            break;
+        }
+    }
+
+    size_t len = wcslen(p);
+    while (len > 0 && (p[len - 1] == L' ' || p[len - 1] == L'\t')) len--;
+    if (len == 0) return false;
+
+    unsigned key = 0;
+    if (len > 2 && p[0] == L'0' && (p[1] == L'x' || p[1] == L'X')) {
+        wchar_t* end = nullptr;
+        unsigned long value = wcstoul(p + 2, &end, 16);
+        if (end != p + len || value == 0 || value > 0xFF) return false;
+        key = (unsigned)value;
+    }
+    else key = table.FindKey(p, len);
+    if (key == 0 || IsModifierKey(key)) return false;
+
+    *modifiers = mods;
+    *vk = key;
+    return true;
+}
+
+// --- Hotkey Setting ---
+
+void LoadHotkeySetting(const Settings& settings, const KeyNameTable& table, unsigned* modifiers, unsigned* vk) {
+    if (settings.Find(L"Settings", L"Key") || settings.Find(L"Settings", L"Modifiers")) {
+        *vk = (unsigned)settings.GetInt(L"Settings", L"Key", (int)*vk);
+        *modifiers = (unsigned)settings.GetInt(L"Settings", L"Modifiers", (int)*modifiers);
+        return;
+    }
+    const std::wstring* text = settings.Find(L"Settings", L"Hotkey");
+    unsigned mods, key;
+    if (text && ParseHotkey(table, text->c_str(), &mods, &key)) {
+        *modifiers = mods;
+        *vk = key;
+    }
+}
+
+void StoreHotkeySetting(Settings* settings, unsigned modifiers, unsigned vk) {
+    settings->SetInt(L"Settings", L"Key", (int)vk);
+    settings->SetInt(L"Settings", L"Modifiers", (int)modifiers);
+    settings->Remove(L"Settings", L"Hotkey");
+}
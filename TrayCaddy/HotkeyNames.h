@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class Settings;
+
+// --- Hotkey Names ---
+// Display names for hotkeys. Key names come from the keyboard layout and are
+// looked up once per layout into a fixed table; formatting then only copies
+// into a caller-provided buffer.
+
+// Same values as MOD_ALT / MOD_CONTROL / MOD_SHIFT / MOD_WIN
+#define HK_MOD_ALT     0x0001
+#define HK_MOD_CONTROL 0x0002
+#define HK_MOD_SHIFT   0x0004
+#define HK_MOD_WIN     0x0008
+
+#define KEY_NAME_MAX    32 // Per key, including the terminator
+#define HOTKEY_TEXT_MAX 96 // Enough for all four modifiers and any key name
+
+struct MODIFIER_NAME {
+    unsigned flag;
+    const wchar_t* name;
+};
+
+// In display order
+constexpr MODIFIER_NAME MODIFIER_NAMES[] = {
+    { HK_MOD_WIN, L"Win" },
+    { HK_MOD_CONTROL, L"Ctrl" },
+    { HK_MOD_SHIFT, L"Shift" },
+    { HK_MOD_ALT, L"Alt" },
+};
+
+// Virtual keys whose scan code needs the extended bit for GetKeyNameText
+constexpr unsigned EXTENDED_KEYS[] = {
+    0x21, 0x22, 0x23, 0x24, // VK_PRIOR, VK_NEXT, VK_END, VK_HOME
+    0x25, 0x26, 0x27, 0x28, // VK_LEFT, VK_UP, VK_RIGHT, VK_DOWN
+    0x2D, 0x2E,             // VK_INSERT, VK_DELETE
+    0x6F, 0x90,             // VK_DIVIDE, VK_NUMLOCK
+};
+
+// Virtual keys that only act as modifiers and are never the hotkey itself
+constexpr unsigned MODIFIER_KEYS[] = {
+    0x10, 0x11, 0x12,             // VK_SHIFT, VK_CONTROL, VK_MENU
+    0x5B, 0x5C,                   // VK_LWIN, VK_RWIN
+    0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, // VK_LSHIFT .. VK_RMENU
+};
+
+template <size_t N>
+constexpr std::array<bool, 256> MakeKeyMask(const unsigned (&keys)[N]) {
+    std::array<bool, 256> mask = {};
+    for (unsigned key : keys) mask[key & 0xFF] = true;
+    return mask;
+}
+
+constexpr std::array<bool, 256> EXTENDED_KEY_MASK = MakeKeyMask(EXTENDED_KEYS);
+constexpr std::array<bool, 256> MODIFIER_KEY_MASK = MakeKeyMask(MODIFIER_KEYS);
+
+constexpr bool IsExtendedKey(unsigned vk) { return vk < 256 && EXTENDED_KEY_MASK[vk]; }
+constexpr bool IsModifierKey(unsigned vk) { return vk < 256 && MODIFIER_KEY_MASK[vk]; }
+
+// Source of key names for the active keyboard layout.
+class IKeyboardLayout {
+public:
+    virtual ~IKeyboardLayout() = default;
+    virtual uintptr_t GetLayoutId() = 0;
+    // Writes the name of vk into buf; returns false if the layout has none.
+    virtual bool GetKeyName(unsigned vk, bool extended, wchar_t* buf, size_t bufLen) = 0;
+};
+
+class KeyNameTable {
+public:
+    // Rebuilds the table if the layout changed since the last call.
+    void EnsureLayout(IKeyboardLayout* layout);
+    void Invalidate() { valid = false; }
+
+    const wchar_t* GetName(unsigned vk) const; // nullptr if the key has no name
+    unsigned FindKey(const wchar_t* name, size_t len) const; // 0 if not found
+
+private:
+    bool valid = false;
+    uintptr_t layoutId = 0;
+    wchar_t names[256][KEY_NAME_MAX] = {};
+};
+
+// Formats e.g. "Win + Shift + Z" into buf and returns the length written.
+// The output is always terminated and truncated to fit.
+size_t FormatHotkey(const KeyNameTable& table, unsigned modifiers, unsigned vk, wchar_t* buf, size_t bufLen);
+
+// Inverse of FormatHotkey. Modifier names are matched case-insensitively and
+// "Control" is accepted for "Ctrl"; the key may also be given as a hex virtual
+// key code such as "0x5A".
+bool ParseHotkey(const KeyNameTable& table, const wchar_t* text, unsigned* modifiers, unsigned* vk);
+
+// --- Hotkey Setting ---
+// [Settings] Key and Modifiers hold the hotkey as numbers, which mean the same
+// under every keyboard layout. A readable "Hotkey=Ctrl + Alt + H" line is only
+// used when neither number is present, e.g. in a hand-written file; otherwise
+// it could override a newer edit of the numbers. modifiers and vk hold the
+// defaults on entry and are left alone if the file sets no hotkey.
+void LoadHotkeySetting(const Settings& settings, const KeyNameTable& table, unsigned* modifiers, unsigned* vk);
+
+// Writes the numeric pair and drops any Hotkey= line, so the file never holds
+// two copies that can disagree.
+void StoreHotkeySetting(Settings* settings, unsigned modifiers, unsigned vk);
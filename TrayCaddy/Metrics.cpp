@@ -0,0 +1,265 @@
+#include "Metrics.h"
+#include "Settings.h"
+
+#include <cstdio>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <csignal>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// --- Histogram ---
+
+Histogram::Histogram(const std::vector<uint64_t>& boundList, double unitScale) : unitScale(unitScale) {
+    for (uint64_t bound : boundList) {
+        if (boundCount == HISTOGRAM_MAX_BUCKETS - 1) break;
+        if (boundCount && bound <= bounds[boundCount - 1]) continue; // Must be increasing
+        bounds[boundCount++] = bound;
+    }
+}
+
+void Histogram::Snapshot(std::vector<uint64_t>* counts, uint64_t* total, uint64_t* valueSum) const {
+    counts->resize(boundCount + 1);
+    *total = 0;
+    for (size_t i = 0; i <= boundCount; i++) {
+        (*counts)[i] = buckets[i].load(std::memory_order_relaxed);
+        *total += (*counts)[i];
+    }
+    *valueSum = sum.load(std::memory_order_relaxed);
+}
+
+const std::vector<uint64_t>& LatencyBucketsUs() {
+    static const std::vector<uint64_t> bounds = {
+        50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000,
+    };
+    return bounds;
+}
+
+// --- Registry ---
+
+static bool IsMetricName(const std::string& name) {
+    if (name.empty() || (name[0] >= '0' && name[0] <= '9')) return false;
+    for (char c : name) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == ':')) return false;
+    }
+    return true;
+}
+
+// Caller holds lock and fills in the value before the next entry is added. Null
+// for a name the text format can't carry or one already taken.
+MetricsRegistry::METRIC_ENTRY* MetricsRegistry::NewEntry(const std::string& name, const std::string& help, METRIC_TYPE type) {
+    if (!IsMetricName(name) || !names.insert(name).second) return nullptr;
+    METRIC_ENTRY entry;
+    entry.name = name;
+    entry.help = help;
+    entry.type = type;
+    entries.push_back(std::move(entry));
+    return &entries.back();
+}
+
+Counter* MetricsRegistry::AddCounter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> guard(lock);
+    METRIC_ENTRY* entry = NewEntry(name, help, METRIC_COUNTER);
+    if (!entry) return nullptr;
+    entry->counter = std::make_unique<Counter>();
+    return entry->counter.get();
+}
+
+Gauge* MetricsRegistry::AddGauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> guard(lock);
+    METRIC_ENTRY* entry = NewEntry(name, help, METRIC_GAUGE);
+    if (!entry) return nullptr;
+    entry->gauge = std::make_unique<Gauge>();
+    return entry->gauge.get();
+}
+
+Histogram* MetricsRegistry::AddHistogram(const std::string& name, const std::string& help, const std::vector<uint64_t>& bounds, double unitScale) {
+    std::lock_guard<std::mutex> guard(lock);
+    METRIC_ENTRY* entry = NewEntry(name, help, METRIC_HISTOGRAM);
+    if (!entry) return nullptr;
+    entry->histogram = std::make_unique<Histogram>(bounds, unitScale);
+    return entry->histogram.get();
+}
+
+// HELP text may not hold a raw newline, and a backslash starts an escape
+static void AppendHelp(std::string* out, const std::string& help) {
+    for (char c : help) {
+        if (c == '\\') out->append("\\\\");
+        else if (c == '\n') out->append("\\n");
+        else out->push_back(c);
+    }
+}
+
+static void AppendDouble(std::string* out, const char* format, double value) {
+    char number[32]; // Ample for %g and %.9g
+    int len = snprintf(number, sizeof(number), format, value);
+    if (len > 0) out->append(number, (size_t)len);
+}
+
+// Appends "<name><suffix>[{le="<le>"}] " so only the value is left to add; nothing
+// goes through a fixed buffer, so long names can't cut a line short.
+static void AppendSample(std::string* out, const std::string& name, const char* suffix, const char* le = nullptr) {
+    out->append(name).append(suffix);
+    if (le) out->append("{le=\"").append(le).append("\"}");
+    out->push_back(' ');
+}
+
+void MetricsRegistry::FormatPrometheus(std::string* out) const {
+    static const char* typeNames[] = { "counter", "gauge", "histogram" };
+    std::vector<uint64_t> counts;
+    char le[32];
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (const auto& entry : entries) {
+        const std::string& name = entry.name;
+        out->append("# HELP ").append(name).push_back(' ');
+        AppendHelp(out, entry.help);
+        out->append("\n# TYPE ").append(name).append(" ").append(typeNames[entry.type]).push_back('\n');
+        switch (entry.type) {
+        case METRIC_COUNTER:
+            AppendSample(out, name, "");
+            out->append(std::to_string(entry.counter->Get())).push_back('\n');
+            break;
+        case METRIC_GAUGE:
+            AppendSample(out, name, "");
+            out->append(std::to_string(entry.gauge->Get())).push_back('\n');
+            break;
+        case METRIC_HISTOGRAM: {
+            const Histogram& h = *entry.histogram;
+            uint64_t total, sum;
+            h.Snapshot(&counts, &total, &sum);
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < h.GetBoundCount(); i++) {
+                cumulative += counts[i];
+                snprintf(le, sizeof(le), "%g", h.GetBound(i) * h.GetUnitScale());
+                AppendSample(out, name, "_bucket", le);
+                out->append(std::to_string(cumulative)).push_back('\n');
+            }
+            AppendSample(out, name, "_bucket", "+Inf");
+            out->append(std::to_string(total)).push_back('\n');
+            AppendSample(out, name, "_sum");
+            AppendDouble(out, "%.9g", sum * h.GetUnitScale());
+            out->push_back('\n');
+            AppendSample(out, name, "_count");
+            out->append(std::to_string(total)).push_back('\n');
+            break;
+        }
+        }
+    }
+}
+
+// --- Exporter ---
+
+bool WriteMetricsText(const std::wstring& path, const std::string& text) {
+#ifdef _WIN32
+    if (_wcsnicmp(path.c_str(), L"\\\\.\\pipe\\", 9) == 0) {
+        HANDLE pipe = CreateFileW(path.c_str(), GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+        if (pipe == INVALID_HANDLE_VALUE) return false; // No listener
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+        DWORD written = 0;
+        bool ok = overlapped.hEvent != NULL, pending = false;
+        if (ok && !WriteFile(pipe, text.data(), (DWORD)text.size(), NULL, &overlapped)) {
+            pending = ok = GetLastError() == ERROR_IO_PENDING;
+            if (pending && WaitForSingleObject(overlapped.hEvent, METRICS_PIPE_TIMEOUT_MS) != WAIT_OBJECT_0) {
+                // The reader stalled; drop this dump rather than hold up the exporter
+                CancelIo(pipe);
+                ok = false;
+            }
+        }
+        // A cancelled write must still complete before overlapped goes out of scope
+        if (ok || pending) ok = GetOverlappedResult(pipe, &overlapped, &written, TRUE) && ok && written == text.size();
+        if (overlapped.hEvent) CloseHandle(overlapped.hEvent);
+        CloseHandle(pipe);
+        return ok;
+    }
+#else
+    std::error_code ec;
+    std::filesystem::path file(path);
+    if (std::filesystem::is_fifo(file, ec)) {
+        int fd = open(file.c_str(), O_WRONLY | O_NONBLOCK); // Fails with ENXIO when nobody reads
+        if (fd < 0) return false;
+        // A reader that closes mid-dump raises SIGPIPE, whose default action ends the
+        // process. Block it on this thread for the write, so write fails with EPIPE
+        // instead, and consume the one we caused before the mask is restored.
+        sigset_t pipeSignal, pendingSignals, oldMask;
+        sigemptyset(&pipeSignal);
+        sigaddset(&pipeSignal, SIGPIPE);
+        sigpending(&pendingSignals);
+        bool alreadyPending = sigismember(&pendingSignals, SIGPIPE) == 1;
+        pthread_sigmask(SIG_BLOCK, &pipeSignal, &oldMask);
+
+        // Stays non-blocking: a reader that stops draining the FIFO costs at most the timeout
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(METRICS_PIPE_TIMEOUT_MS);
+        bool ok = true, brokenPipe = false;
+        for (size_t done = 0; ok && done < text.size();) {
+            ssize_t n = write(fd, text.data() + done, text.size() - done);
+            if (n >= 0) { done += (size_t)n; continue; }
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN) { brokenPipe = errno == EPIPE; ok = false; break; } // EPIPE: the reader went away, drop the dump
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            pollfd writable = { fd, POLLOUT, 0 };
+            ok = left > 0 && poll(&writable, 1, (int)left) > 0 && !(writable.revents & (POLLERR | POLLHUP));
+        }
+        close(fd);
+
+        if (brokenPipe && !alreadyPending) {
+            timespec noWait = { 0, 0 };
+            while (sigtimedwait(&pipeSignal, NULL, &noWait) < 0 && errno == EINTR) {}
+        }
+        pthread_sigmask(SIG_SETMASK, &oldMask, NULL);
+        return ok;
+    }
+#endif
+    return WriteFileAtomic(path, text);
+}
+
+MetricsExporter::~MetricsExporter() { Stop(); }
+
+void MetricsExporter::Start(const std::wstring& newPath, unsigned newIntervalMs, std::function<void()> callback) {
+    Stop();
+    path = newPath;
+    onCollect = std::move(callback);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = false;
+        intervalMs = newIntervalMs ? newIntervalMs : 15000;
+    }
+    worker = std::thread(&MetricsExporter::Run, this);
+}
+
+void MetricsExporter::Stop() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+bool MetricsExporter::ExportNow() {
+    std::lock_guard<std::mutex> guard(exportLock);
+    if (onCollect) onCollect();
+    buffer.clear();
+    registry->FormatPrometheus(&buffer);
+    if (!WriteMetricsText(path, buffer)) return false;
+    exports.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void MetricsExporter::Run() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!stopping) {
+        guard.unlock();
+        ExportNow();
+        guard.lock();
+        wake.wait_for(guard, std::chrono::milliseconds(intervalMs), [this] { return stopping; });
+    }
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// --- Metrics ---
+// Counters, gauges and histograms that hot paths update with one relaxed
+// atomic add and no locks. The registry owns them and renders Prometheus
+// text format; the exporter writes that to a file or pipe on a timer.
+
+class Counter {
+public:
+    void Add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t Get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value{ 0 };
+};
+
+class Gauge {
+public:
+    void Set(int64_t v) { value.store(v, std::memory_order_relaxed); }
+    void Add(int64_t n) { value.fetch_add(n, std::memory_order_relaxed); }
+    int64_t Get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value{ 0 };
+};
+
+#define HISTOGRAM_MAX_BUCKETS 24
+
+// Fixed upper bounds in integer units (e.g. microseconds); unitScale converts
+// them to the exported unit (1e-6 for seconds). The total count is the sum of
+// the buckets, so Observe touches exactly two atomics.
+class Histogram {
+public:
+    Histogram(const std::vector<uint64_t>& bounds, double unitScale);
+
+    void Observe(uint64_t value) {
+        size_t i = 0;
+        while (i < boundCount && value > bounds[i]) i++;
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    // Non-cumulative bucket counts, the last one being +Inf.
+    void Snapshot(std::vector<uint64_t>* counts, uint64_t* total, uint64_t* valueSum) const;
+    size_t GetBoundCount() const { return boundCount; }
+    uint64_t GetBound(size_t i) const { return bounds[i]; }
+    double GetUnitScale() const { return unitScale; }
+
+private:
+    size_t boundCount = 0;
+    uint64_t bounds[HISTOGRAM_MAX_BUCKETS - 1] = {};
+    std::atomic<uint64_t> buckets[HISTOGRAM_MAX_BUCKETS] = {};
+    std::atomic<uint64_t> sum{ 0 };
+    double unitScale;
+};
+
+// 50us .. 1s, for timings of UI-thread work.
+const std::vector<uint64_t>& LatencyBucketsUs();
+
+// Observes the elapsed microseconds on destruction; does nothing (not even
+// read the clock) when histogram is null, so metrics can stay optional.
+class HistogramTimer {
+public:
+    explicit HistogramTimer(Histogram* histogram) : histogram(histogram) {
+        if (histogram) start = std::chrono::steady_clock::now();
+    }
+    ~HistogramTimer() {
+        if (!histogram) return;
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        histogram->Observe((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+    HistogramTimer(const HistogramTimer&) = delete;
+    HistogramTimer& operator=(const HistogramTimer&) = delete;
+
+private:
+    Histogram* histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// --- Registry ---
+
+enum METRIC_TYPE {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM,
+};
+
+class MetricsRegistry {
+public:
+    // Names follow Prometheus rules ([a-zA-Z_:][a-zA-Z0-9_:]*); an invalid or
+    // already registered name returns null. The returned pointers stay valid
+    // for the registry's lifetime.
+    Counter* AddCounter(const std::string& name, const std::string& help);
+    Gauge* AddGauge(const std::string& name, const std::string& help);
+    Histogram* AddHistogram(const std::string& name, const std::string& help, const std::vector<uint64_t>& bounds, double unitScale);
+
+    // Prometheus text exposition format, version 0.0.4.
+    void FormatPrometheus(std::string* out) const;
+
+private:
+    struct METRIC_ENTRY {
+        std::string name;
+        std::string help;
+        METRIC_TYPE type = METRIC_COUNTER;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    METRIC_ENTRY* NewEntry(const std::string& name, const std::string& help, METRIC_TYPE type);
+
+    mutable std::mutex lock; // Registration and formatting only
+    std::vector<METRIC_ENTRY> entries;
+    std::unordered_set<std::string> names;
+};
+
+// --- Exporter ---
+
+#define METRICS_PIPE_TIMEOUT_MS 1000 // Longest a pipe write may wait for a slow reader
+
+// Writes text to path. Regular files are replaced atomically so a scraper
+// never reads half a dump; pipes (\\.\pipe\... on Windows, FIFOs elsewhere)
+// are written directly and skipped when nobody is listening. A reader that
+// stops draining the pipe gets the dump dropped (false) after
+// METRICS_PIPE_TIMEOUT_MS, possibly mid-dump; one that closes mid-dump gets
+// it dropped at once, without a SIGPIPE.
+bool WriteMetricsText(const std::wstring& path, const std::string& text);
+
+class MetricsExporter {
+public:
+    explicit MetricsExporter(const MetricsRegistry* registry) : registry(registry) {}
+    ~MetricsExporter();
+
+    // onCollect runs on the exporter thread before each dump, for gauges that
+    // are sampled rather than pushed (memory, handle counts).
+    void Start(const std::wstring& path, unsigned intervalMs, std::function<void()> onCollect);
+    // Returns within METRICS_PIPE_TIMEOUT_MS even if a pipe reader stalled.
+    void Stop();
+    bool IsRunning() const { return worker.joinable(); }
+
+    // Runs one collect and dump on the calling thread.
+    bool ExportNow();
+
+    uint64_t GetExportCount() const { return exports.load(std::memory_order_relaxed); }
+
+private:
+    void Run();
+
+    const MetricsRegistry* registry;
+    std::wstring path;
+    std::function<void()> onCollect;
+    std::mutex exportLock; // ExportNow may race the worker
+    std::string buffer;    // Reused between dumps
+    std::atomic<uint64_t> exports{ 0 };
+
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping = false;
+    unsigned intervalMs = 15000;
+};
@@ -0,0 +1,264 @@
+#include "ProcessStats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cwchar>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#pragma comment(lib, "Psapi.lib")
+#else
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif
+
+// --- Platform Sources ---
+
+#ifdef _WIN32
+
+class Win32ProcessStats : public IProcessStats {
+public:
+    void QueryBatch(const std::vector<uint32_t>& pids, std::vector<PROCESS_SAMPLE>& out) override {
+        out.resize(pids.size());
+        for (size_t i = 0; i < pids.size(); i++) {
+            PROCESS_SAMPLE& s = out[i];
+            s = PROCESS_SAMPLE();
+            s.pid = pids[i];
+            HANDLE hProc = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pids[i]);
+            if (!hProc) continue;
+
+            FILETIME ftCreate, ftExit, ftKernel, ftUser;
+            PROCESS_MEMORY_COUNTERS pmc = { sizeof(PROCESS_MEMORY_COUNTERS) };
+            if (GetProcessTimes(hProc, &ftCreate, &ftExit, &ftKernel, &ftUser) &&
+                GetProcessMemoryInfo(hProc, &pmc, sizeof(pmc))) {
+                ULARGE_INTEGER k, u;
+                k.LowPart = ftKernel.dwLowDateTime; k.HighPart = ftKernel.dwHighDateTime;
+                u.LowPart = ftUser.dwLowDateTime; u.HighPart = ftUser.dwHighDateTime;
+                s.cpuTime = k.QuadPart + u.QuadPart;
+                s.workingSet = pmc.WorkingSetSize;
+                s.valid = true;
+            }
+            CloseHandle(hProc);
+        }
+    }
+
+    unsigned GetProcessorCount() override {
+        DWORD count = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+        return count ? count : 1;
+    }
+};
+
+std::unique_ptr<IProcessStats> CreateProcessStats() { return std::make_unique<Win32ProcessStats>(); }
+
+#else
+
+class ProcFsProcessStats : public IProcessStats {
+public:
+    ProcFsProcessStats() {
+        long ticks = sysconf(_SC_CLK_TCK);
+        long page = sysconf(_SC_PAGESIZE);
+        ticksTo100ns = ticks > 0 ? 10000000ull / (uint64_t)ticks : 100000ull;
+        pageSize = page > 0 ? (uint64_t)page : 4096;
+    }
+
+    void QueryBatch(const std::vector<uint32_t>& pids, std::vector<PROCESS_SAMPLE>& out) override {
+        out.resize(pids.size());
+        for (size_t i = 0; i < pids.size(); i++) {
+            PROCESS_SAMPLE& s = out[i];
+            s = PROCESS_SAMPLE();
+            s.pid = pids[i];
+
+            uint64_t utime = 0, stime = 0, resident = 0;
+            if (!ReadStat(pids[i], &utime, &stime) || !ReadStatm(pids[i], &resident)) continue;
+            s.cpuTime = (utime + stime) * ticksTo100ns;
+            s.workingSet = resident * pageSize;
+            s.valid = true;
+        }
+    }
+
+    unsigned GetProcessorCount() override {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (unsigned)count : 1;
+    }
+
+private:
+    static bool ReadStat(uint32_t pid, uint64_t* utime, uint64_t* stime) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+        std::ifstream file(path);
+        if (!file.is_open()) return false;
+        std::string line;
+        if (!std::getline(file, line)) return false;
+        return ParseProcStat(line, utime, stime);
+    }
+
+    static bool ReadStatm(uint32_t pid, uint64_t* resident) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%u/statm", pid);
+        std::ifstream file(path);
+        uint64_t size = 0;
+        return file.is_open() && (bool)(file >> size >> *resident);
+    }
+
+    uint64_t ticksTo100ns;
+    uint64_t pageSize;
+};
+
+std::unique_ptr<IProcessStats> CreateProcessStats() { return std::make_unique<ProcFsProcessStats>(); }
+
+// utime and stime are fields 14 and 15 of /proc/<pid>/stat. The command name
+// in field 2 may contain spaces and parentheses, so parsing starts after the
+// last ')'.
+bool ParseProcStat(const std::string& line, uint64_t* utime, uint64_t* stime) {
+    size_t pos = line.rfind(')');
+    if (pos == std::string::npos) return false;
+
+    std::istringstream fields(line.substr(pos + 1));
+    std::string skip;
+    for (int i = 3; i < 14; i++) if (!(fields >> skip)) return false;
+    return (bool)(fields >> *utime >> *stime);
+}
+
+#endif
+
+// --- Rate Computation ---
+
+void ComputeUsage(const std::unordered_map<uint32_t, PROCESS_SAMPLE>& previous,
+    const std::vector<PROCESS_SAMPLE>& current, uint64_t elapsed100ns, unsigned processors,
+    std::vector<PROCESS_USAGE>& out) {
+    out.clear();
+    if (processors == 0) processors = 1;
+    for (const auto& s : current) {
+        if (!s.valid) continue;
+        PROCESS_USAGE u;
+        u.pid = s.pid;
+        u.workingSet = s.workingSet;
+        auto prev = previous.find(s.pid);
+        // A pid that was recycled can report less CPU time than before; treat it as new.
+        if (prev != previous.end() && prev->second.valid && elapsed100ns > 0 && s.cpuTime >= prev->second.cpuTime) {
+            double delta = (double)(s.cpuTime - prev->second.cpuTime);
+            u.cpuPercent = delta * 100.0 / ((double)elapsed100ns * processors);
+            if (u.cpuPercent > 100.0) u.cpuPercent = 100.0;
+        }
+        out.push_back(u);
+    }
+}
+
+// --- Sampler ---
+
+StatsSampler::StatsSampler(std::unique_ptr<IProcessStats> source, unsigned intervalMs)
+    : source(std::move(source)), intervalMs(intervalMs ? intervalMs : 1000) {}
+
+StatsSampler::~StatsSampler() { Stop(); }
+
+void StatsSampler::Start(std::function<void()> callback) {
+    if (worker.joinable()) return;
+    onUpdate = std::move(callback);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = false;
+    }
+    worker = std::thread(&StatsSampler::Run, this);
+}
+
+void StatsSampler::Stop() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void StatsSampler::SetPids(const std::vector<uint32_t>& newPids) {
+    std::lock_guard<std::mutex> guard(lock);
+    pids = newPids;
+}
+
+void StatsSampler::SetInterval(unsigned newIntervalMs) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        intervalMs = newIntervalMs ? newIntervalMs : 1000;
+    }
+    wake.notify_all();
+}
+
+bool StatsSampler::GetUsage(uint32_t pid, PROCESS_USAGE* out) const {
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = usage.find(pid);
+    if (it == usage.end()) return false;
+    *out = it->second;
+    return true;
+}
+
+void StatsSampler::CopyUsage(std::unordered_map<uint32_t, PROCESS_USAGE>* out) const {
+    std::lock_guard<std::mutex> guard(lock);
+    *out = usage;
+}
+
+void StatsSampler::SampleNow() {
+    std::vector<uint32_t> batch;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        batch = pids;
+    }
+
+    std::lock_guard<std::mutex> sampleGuard(sampleLock);
+    auto now = std::chrono::steady_clock::now();
+    source->QueryBatch(batch, scratch);
+
+    uint64_t elapsed = 0;
+    if (!lastSamples.empty()) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastSampleTime).count();
+        elapsed = ns > 0 ? (uint64_t)ns / 100 : 0;
+    }
+
+    std::vector<PROCESS_USAGE> results;
+    ComputeUsage(lastSamples, scratch, elapsed, source->GetProcessorCount(), results);
+
+    lastSamples.clear();
+    for (const auto& s : scratch) if (s.valid) lastSamples[s.pid] = s;
+    lastSampleTime = now;
+
+    std::lock_guard<std::mutex> guard(lock);
+    usage.clear();
+    for (const auto& u : results) usage[u.pid] = u;
+}
+
+void StatsSampler::Run() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!stopping) {
+        guard.unlock();
+        SampleNow();
+        if (onUpdate) onUpdate();
+        guard.lock();
+        // The deadline is recomputed on every wake, so SetInterval takes effect
+        // at once instead of after the wait it interrupted
+        auto rested = std::chrono::steady_clock::now();
+        while (!stopping) {
+            auto due = rested + std::chrono::milliseconds(intervalMs);
+            if (std::chrono::steady_clock::now() >= due) break;
+            wake.wait_until(guard, due);
+        }
+    }
+}
+
+// --- Cost Ordering ---
+
+void SortUsageKeys(std::vector<USAGE_SORT_KEY>& keys, USAGE_ORDER order) {
+    if (order == ORDER_AS_GIVEN) return;
+    std::stable_sort(keys.begin(), keys.end(), [order](const USAGE_SORT_KEY& a, const USAGE_SORT_KEY& b) {
+        if (a.measured != b.measured) return a.measured;
+        if (order == ORDER_BY_CPU) return a.cpuPercent > b.cpuPercent;
+        return a.workingSet > b.workingSet;
+    });
+}
+
+void FormatBytes(uint64_t bytes, wchar_t* buf, size_t bufLen) {
+    if (bytes >= 1024ull * 1024 * 1024) swprintf(buf, bufLen, L"%.1f GB", bytes / (1024.0 * 1024 * 1024));
+    else if (bytes >= 1024ull * 1024) swprintf(buf, bufLen, L"%.1f MB", bytes / (1024.0 * 1024));
+    else swprintf(buf, bufLen, L"%llu KB", (unsigned long long)(bytes / 1024));
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <unordered_map>
+
+// --- Process Statistics ---
+// Raw counters for one process. cpuTime is user + kernel time in 100ns units
+// so Win32 FILETIME values and /proc clock ticks land on the same scale.
+
+struct PROCESS_SAMPLE {
+    uint32_t pid = 0;
+    bool valid = false;
+    uint64_t cpuTime = 0;
+    uint64_t workingSet = 0; // bytes
+};
+
+// Derived usage for one process, computed between two consecutive samples.
+struct PROCESS_USAGE {
+    uint32_t pid = 0;
+    double cpuPercent = 0.0; // share of the whole machine, 0..100
+    uint64_t workingSet = 0;
+};
+
+// Source of raw counters. The sampler only talks to this interface, so the
+// rate and aggregation logic runs the same on Windows and Linux (/proc).
+class IProcessStats {
+public:
+    virtual ~IProcessStats() = default;
+    // Fills one sample per pid, in the same order. Processes that have exited
+    // or cannot be opened come back with valid = false.
+    virtual void QueryBatch(const std::vector<uint32_t>& pids, std::vector<PROCESS_SAMPLE>& out) = 0;
+    virtual unsigned GetProcessorCount() = 0;
+};
+
+std::unique_ptr<IProcessStats> CreateProcessStats();
+
+#ifndef _WIN32
+// Reads utime and stime (clock ticks) from one line of /proc/<pid>/stat.
+bool ParseProcStat(const std::string& line, uint64_t* utime, uint64_t* stime);
+#endif
+
+// Computes CPU rates from two sample sets taken elapsed100ns apart.
+void ComputeUsage(const std::unordered_map<uint32_t, PROCESS_SAMPLE>& previous,
+    const std::vector<PROCESS_SAMPLE>& current, uint64_t elapsed100ns, unsigned processors,
+    std::vector<PROCESS_USAGE>& out);
+
+// Background thread that samples the tracked pids at a fixed interval. The UI
+// thread hands over the pid set with SetPids and reads results with GetUsage
+// or CopyUsage; onUpdate is invoked from the sampler thread after every batch.
+// A new pid set is picked up on the next regular pass, so CPU rates are always
+// measured over a whole interval.
+class StatsSampler {
+public:
+    StatsSampler(std::unique_ptr<IProcessStats> source, unsigned intervalMs);
+    ~StatsSampler();
+
+    void Start(std::function<void()> onUpdate);
+    void Stop();
+    void SetPids(const std::vector<uint32_t>& pids);
+    void SetInterval(unsigned intervalMs); // Also shortens or stretches the wait in progress
+    bool GetUsage(uint32_t pid, PROCESS_USAGE* usage) const;
+    // All results under one lock, for callers that look up many pids.
+    void CopyUsage(std::unordered_map<uint32_t, PROCESS_USAGE>* out) const;
+
+    // Runs one sampling pass on the calling thread.
+    void SampleNow();
+
+private:
+    void Run();
+
+    std::unique_ptr<IProcessStats> source;
+    std::function<void()> onUpdate;
+    std::thread worker;
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    bool stopping = false;
+    unsigned intervalMs;
+
+    std::vector<uint32_t> pids;
+    std::unordered_map<uint32_t, PROCESS_USAGE> usage;
+
+    // Owned by whichever thread is sampling (guarded by sampleLock).
+    std::mutex sampleLock;
+    std::unordered_map<uint32_t, PROCESS_SAMPLE> lastSamples;
+    std::chrono::steady_clock::time_point lastSampleTime;
+    std::vector<PROCESS_SAMPLE> scratch;
+};
+
+// --- Cost Ordering ---
+
+enum USAGE_ORDER {
+    ORDER_AS_GIVEN, // Keep the caller's order, e.g. the order windows were hidden
+    ORDER_BY_CPU,
+    ORDER_BY_MEMORY,
+};
+
+// One row to sort, with its usage looked up once up front.
+struct USAGE_SORT_KEY {
+    unsigned id = 0;        // Caller's item id, e.g. a tray icon id
+    bool measured = false;  // False until the sampler has seen the process
+    double cpuPercent = 0.0;
+    uint64_t workingSet = 0;
+};
+
+// Most expensive first. Rows without a measurement go after the measured ones;
+// ties keep their input order, and ORDER_AS_GIVEN leaves keys untouched.
+void SortUsageKeys(std::vector<USAGE_SORT_KEY>& keys, USAGE_ORDER order);
+
+// Formats a byte count as "12.3 MB" style text.
+void FormatBytes(uint64_t bytes, wchar_t* buf, size_t bufLen);
@@ -0,0 +1,513 @@
+#include "Settings.h"
+
+#include <chrono>
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define SETTINGS_SETTLE_MS   200 // Leave files alone while an editor may still be writing them
+#define SETTINGS_SAVE_WAITS  5   // Settle periods a save waits out before merging a file that keeps changing
+
+// --- Text Encoding ---
+
+static void AppendCodePoint(std::wstring* out, uint32_t cp) {
+    if constexpr (sizeof(wchar_t) == 2) {
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            out->push_back((wchar_t)(0xD800 + (cp >> 10)));
+            out->push_back((wchar_t)(0xDC00 + (cp & 0x3FF)));
+            return;
+        }
+    }
+    out->push_back((wchar_t)cp);
+}
+
+static std::wstring DecodeText(const std::string& data) {
+    const uint8_t* p = (const uint8_t*)data.data();
+    size_t n = data.size(), i = 0;
+    std::wstring text;
+    text.reserve(n);
+
+    if (n >= 2 && p[0] == 0xFF && p[1] == 0xFE) {
+        for (i = 2; i + 1 < n; i += 2) {
+            uint32_t unit = p[i] | (p[i + 1] << 8);
+            if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < n) {
+                uint32_t low = p[i + 2] | (p[i + 3] << 8);
+                if (low >= 0xDC00 && low < 0xE000) {
+                    AppendCodePoint(&text, 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00));
+                    i += 2;
+                    continue;
+                }
+            }
+            text.push_back((wchar_t)unit);
+        }
+        return text;
+    }
+
+    if (n >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) i = 3;
+    while (i < n) {
+        uint8_t b = p[i];
+        if (b < 0x80) { text.push_back((wchar_t)b); i++; continue; }
+
+        size_t len = 0;
+        uint32_t cp = 0;
+        if (b >= 0xC2 && b <= 0xDF) { len = 2; cp = b & 0x1F; }
+        else if (b >= 0xE0 && b <= 0xEF) { len = 3; cp = b & 0x0F; }
+        else if (b >= 0xF0 && b <= 0xF4) { len = 4; cp = b & 0x07; }
+
+        bool valid = len != 0 && i + len <= n;
+        for (size_t k = 1; valid && k < len; k++) {
+            if ((p[i + k] & 0xC0) != 0x80) valid = false;
+            else cp = (cp << 6) | (p[i + k] & 0x3F);
+        }
+        if (valid && ((len == 3 && cp < 0x800) || (len == 4 && (cp < 0x10000 || cp > 0x10FFFF)) || (cp >= 0xD800 && cp < 0xE000))) valid = false;
+
+        if (!valid) { text.push_back((wchar_t)b); i++; continue; } // Latin-1
+        AppendCodePoint(&text, cp);
+        i += len;
+    }
+    return text;
+}
+
+static void AppendUtf8(std::string* out, const std::wstring& text) {
+    for (size_t i = 0; i < text.size(); i++) {
+        uint32_t cp = (uint32_t)text[i];
+        if constexpr (sizeof(wchar_t) == 2) {
+            if (cp >= 0xD800 && cp < 0xDC00 && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] < 0xE000) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + ((uint32_t)text[++i] - 0xDC00);
+            }
+        }
+        if (cp < 0x80) out->push_back((char)cp);
+        else if (cp < 0x800) {
+            out->push_back((char)(0xC0 | (cp >> 6)));
+            out->push_back((char)(0x80 | (cp & 0x3F)));
+        }
+        else if (cp < 0x10000) {
+            out->push_back((char)(0xE0 | (cp >> 12)));
+            out->push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+            out->push_back((char)(0x80 | (cp & 0x3F)));
+        }
+        else {
+            out->push_back((char)(0xF0 | (cp >> 18)));
+            out->push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+            out->push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+            out->push_back((char)(0x80 | (cp & 0x3F)));
+        }
+    }
+}
+
+// --- Document ---
+
+static wchar_t FoldCase(wchar_t ch) {
+    if (ch < 0x80) return (ch >= L'A' && ch <= L'Z') ? (wchar_t)(ch + 32) : ch; // Skip the locale lookup for ASCII
+    return (wchar_t)towlower(ch);
+}
+
+static std::wstring ToLowerKey(const std::wstring& section, const std::wstring* key = nullptr) {
+    std::wstring lower;
+    lower.reserve(section.size() + (key ? key->size() + 1 : 0));
+    for (wchar_t ch : section) lower.push_back(FoldCase(ch));
+    if (key) {
+        lower.push_back(L'\n');
+        for (wchar_t ch : *key) lower.push_back(FoldCase(ch));
+    }
+    return lower;
+}
+
+const std::wstring* Settings::Find(const std::wstring& section, const std::wstring& key) const {
+    auto it = index.find(ToLowerKey(section, &key));
+    if (it == index.end()) return nullptr;
+    return &sections[it->second.first].entries[it->second.second].value;
+}
+
+const SETTINGS_SECTION* Settings::FindSection(const std::wstring& section) const {
+    auto it = sectionIndex.find(ToLowerKey(section));
+    return it == sectionIndex.end() ? nullptr : &sections[it->second];
+}
+
+std::wstring Settings::GetString(const std::wstring& section, const std::wstring& key, const std::wstring& defaultValue) const {
+    const std::wstring* value = Find(section, key);
+    return value ? *value : defaultValue;
+}
+
+int Settings::GetInt(const std::wstring& section, const std::wstring& key, int defaultValue) const {
+    const std::wstring* value = Find(section, key);
+    if (!value || value->empty()) return defaultValue;
+
+    const wchar_t* p = value->c_str();
+    wchar_t* end = nullptr;
+    long long parsed;
+    if (p[0] == L'0' && (p[1] == L'x' || p[1] == L'X')) parsed = (long long)wcstoull(p + 2, &end, 16);
+    else parsed = wcstoll(p, &end, 10);
+    if (end == p || *end != L'\0') return defaultValue;
+    return (int)parsed;
+}
+
+bool Settings::GetBool(const std::wstring& section, const std::wstring& key, bool defaultValue) const {
+    const std::wstring* value = Find(section, key);
+    if (!value) return defaultValue;
+    std::wstring lower = ToLowerKey(*value);
+    if (lower == L"1" || lower == L"true" || lower == L"yes" || lower == L"on") return true;
+    if (lower == L"0" || lower == L"false" || lower == L"no" || lower == L"off") return false;
+    return defaultValue;
+}
+
+size_t Settings::AddSection(const std::wstring& name) {
+    auto inserted = sectionIndex.emplace(ToLowerKey(name), sections.size());
+    if (inserted.second) {
+        sections.emplace_back();
+        sections.back().name = name;
+    }
+    return inserted.first->second;
+}
+
+// Leaves entry untouched if the key is already in the section.
+bool Settings::AddEntry(size_t section, SETTINGS_ENTRY&& entry) {
+    std::vector<SETTINGS_ENTRY>& entries = sections[section].entries;
+    if (!index.emplace(ToLowerKey(sections[section].name, &entry.key), std::make_pair(section, entries.size())).second) return false;
+    entries.push_back(std::move(entry));
+    return true;
+}
+
+void Settings::Set(const std::wstring& section, const std::wstring& key, const std::wstring& value) {
+    auto it = index.find(ToLowerKey(section, &key));
+    if (it != index.end()) {
+        sections[it->second.first].entries[it->second.second].value = value;
+        return;
+    }
+    SETTINGS_ENTRY entry;
+    entry.key = key;
+    entry.value = value;
+    AddEntry(AddSection(section), std::move(entry));
+}
+
+void Settings::SetInt(const std::wstring& section, const std::wstring& key, int value) {
+    Set(section, key, std::to_wstring(value));
+}
+
+void Settings::Remove(const std::wstring& section, const std::wstring& key) {
+    auto it = index.find(ToLowerKey(section, &key));
+    if (it == index.end()) return;
+    std::vector<SETTINGS_ENTRY>& entries = sections[it->second.first].entries;
+    entries.erase(entries.begin() + it->second.second);
+    Reindex();
+}
+
+void Settings::Reindex() {
+    sectionIndex.clear();
+    index.clear();
+    for (size_t s = 0; s < sections.size(); s++) {
+        sectionIndex.emplace(ToLowerKey(sections[s].name), s);
+        for (size_t e = 0; e < sections[s].entries.size(); e++) {
+            index.emplace(ToLowerKey(sections[s].name, &sections[s].entries[e].key), std::make_pair(s, e));
+        }
+    }
+}
+
+// --- Parsing ---
+
+static bool IsBlank(wchar_t ch) { return ch == L' ' || ch == L'\t'; }
+
+static void Trim(const std::wstring& text, size_t* begin, size_t* end) {
+    while (*begin < *end && IsBlank(text[*begin])) (*begin)++;
+    while (*end > *begin && IsBlank(text[*end - 1])) (*end)--;
+}
+
+void ParseSettings(const std::string& data, Settings* out) {
+    *out = Settings();
+    std::wstring text = DecodeText(data);
+    std::wstring pending; // Lines that belong above the next section or entry
+    size_t section = (size_t)-1;
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t next = text.find(L'\n', pos);
+        if (next == std::wstring::npos) next = text.size();
+        size_t lineEnd = next;
+        if (lineEnd > pos && text[lineEnd - 1] == L'\r') lineEnd--;
+
+        size_t b = pos, e = lineEnd;
+        Trim(text, &b, &e);
+        bool keep = false;
+
+        if (b == e || text[b] == L';' || text[b] == L'#') keep = true;
+        else if (text[b] == L'[') {
+            size_t close = text.find(L']', b);
+            if (close == std::wstring::npos || close >= e) keep = true;
+            else {
+                size_t nb = b + 1, ne = close;
+                Trim(text, &nb, &ne);
+                size_t count = out->sections.size();
+                section = out->AddSection(text.substr(nb, ne - nb));
+                // A repeated header merges into the first one; its comments stay pending for the next entry
+                if (out->sections.size() > count) {
+                    out->sections[section].leading = std::move(pending);
+                    pending.clear();
+                }
+            }
+        }
+        else {
+            size_t eq = text.find(L'=', b);
+            if (eq == std::wstring::npos || eq >= e) keep = true;
+            else {
+                size_t kb = b, ke = eq, vb = eq + 1, ve = e;
+                Trim(text, &kb, &ke);
+                Trim(text, &vb, &ve);
+                if (kb == ke) keep = true;
+                else {
+                    if (ve - vb >= 2 && text[vb] == L'"' && text[ve - 1] == L'"') { vb++; ve--; }
+                    if (section == (size_t)-1) section = out->AddSection(L""); // Entries before any header
+                    SETTINGS_ENTRY entry;
+                    entry.key.assign(text, kb, ke - kb);
+                    entry.value.assign(text, vb, ve - vb);
+                    entry.leading = std::move(pending);
+                    pending.clear();
+                    // A duplicate key is dropped and the first one wins; its comments move on to the next entry
+                    if (!out->AddEntry(section, std::move(entry))) pending = std::move(entry.leading);
+                }
+            }
+        }
+
+        if (keep) {
+            pending.append(text, pos, lineEnd - pos);
+            pending.push_back(L'\n');
+        }
+        pos = next + 1;
+    }
+    out->trailing = std::move(pending);
+}
+
+// --- Writing ---
+
+static void AppendLines(std::wstring* out, const std::wstring& lines) {
+    for (wchar_t ch : lines) {
+        if (ch == L'\n') out->push_back(L'\r');
+        out->push_back(ch);
+    }
+}
+
+std::string SerializeSettings(const Settings& settings) {
+    std::wstring text;
+    for (size_t i = 0; i < settings.sections.size(); i++) {
+        const SETTINGS_SECTION& section = settings.sections[i];
+        if (!section.leading.empty()) AppendLines(&text, section.leading);
+        else if (!text.empty()) text += L"\r\n";
+        if (i != 0 || !section.name.empty()) {
+            text += L'[';
+            text += section.name;
+            text += L"]\r\n";
+        }
+        for (const auto& entry : section.entries) {
+            AppendLines(&text, entry.leading);
+            text += entry.key;
+            text += L'=';
+            const std::wstring& v = entry.value;
+            // Quote values the parser would otherwise trim or unquote
+            bool quote = !v.empty() && (IsBlank(v.front()) || IsBlank(v.back()) || (v.size() >= 2 && v.front() == L'"' && v.back() == L'"'));
+            if (quote) text += L'"';
+            text += v;
+            if (quote) text += L'"';
+            text += L"\r\n";
+        }
+    }
+    AppendLines(&text, settings.trailing);
+
+    std::string data;
+    data.reserve(text.size());
+    AppendUtf8(&data, text);
+    return data;
+}
+
+bool WriteFileAtomic(const std::wstring& path, const std::string& data) {
+    std::filesystem::path target(path);
+    std::filesystem::path temp = target;
+    temp += L".tmp";
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(temp.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    DWORD written = 0;
+    bool ok = WriteFile(file, data.data(), (DWORD)data.size(), &written, NULL) && written == data.size() && FlushFileBuffers(file);
+    CloseHandle(file);
+    ok = ok && MoveFileExW(temp.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = true;
+    for (size_t done = 0; ok && done < data.size();) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n < 0) ok = false;
+        else done += (size_t)n;
+    }
+    ok = ok && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    ok = ok && rename(temp.c_str(), target.c_str()) == 0;
+#endif
+
+    if (!ok) {
+        std::error_code ec;
+        std::filesystem::remove(temp, ec);
+    }
+    return ok;
+}
+
+// --- Store ---
+
+FILE_SIGNATURE GetFileSignature(const std::wstring& path) {
+    FILE_SIGNATURE signature;
+    std::error_code ec;
+    std::filesystem::path file(path);
+    auto size = std::filesystem::file_size(file, ec);
+    if (ec) return signature;
+    auto time = std::filesystem::last_write_time(file, ec);
+    if (ec) return signature;
+    signature.exists = true;
+    signature.size = (uint64_t)size;
+    signature.writeTime = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    return signature;
+}
+
+static bool IsSettling(const FILE_SIGNATURE& signature) {
+    auto age = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::filesystem::file_time_type::clock::now().time_since_epoch()).count() - signature.writeTime;
+    return age >= 0 && age < (int64_t)SETTINGS_SETTLE_MS * 1000000;
+}
+
+static bool ReadWholeFile(const std::wstring& path, std::string* data) {
+    std::ifstream file(std::filesystem::path(path), std::ios::binary);
+    if (!file.is_open()) return false;
+    data->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+SettingsStore::SettingsStore(std::wstring path) : path(std::move(path)), current(std::make_shared<const Settings>()) {}
+
+SettingsStore::~SettingsStore() { StopWatching(); }
+
+bool SettingsStore::Load() {
+    FILE_SIGNATURE fileSignature = GetFileSignature(path);
+    std::string data;
+    bool found = fileSignature.exists && ReadWholeFile(path, &data);
+    auto settings = std::make_shared<Settings>();
+    if (found) ParseSettings(data, settings.get());
+
+    std::lock_guard<std::mutex> guard(lock);
+    current = std::move(settings);
+    currentData = std::move(data);
+    signature = fileSignature;
+    generation++;
+    return found;
+}
+
+SETTINGS_SNAPSHOT SettingsStore::Get() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return current;
+}
+
+bool SettingsStore::Save(const std::function<void(Settings*)>& edit) {
+    bool merged = false;
+    for (int wait = 0;; wait++) {
+        std::unique_lock<std::mutex> guard(lock);
+        Settings next;
+        FILE_SIGNATURE fileSignature = GetFileSignature(path);
+        // Our own last save leaves the signature stale, so only differing bytes count as an outside edit
+        if (fileSignature.exists && fileSignature != signature) {
+            if (IsSettling(fileSignature) && wait < SETTINGS_SAVE_WAITS) {
+                guard.unlock();
+                std::this_thread::sleep_for(std::chrono::milliseconds(SETTINGS_SETTLE_MS));
+                continue;
+            }
+            std::string data;
+            if (!ReadWholeFile(path, &data)) return false; // Locked by the writer
+            if (data != currentData) {
+                ParseSettings(data, &next);
+                merged = true;
+            }
+            signature = fileSignature;
+        }
+        if (!merged) next = *current;
+
+        edit(&next);
+        std::string data = SerializeSettings(next);
+        if (!WriteFileAtomic(path, data)) return false;
+        current = std::make_shared<const Settings>(std::move(next));
+        currentData = std::move(data);
+        generation++;
+        break;
+    }
+    if (merged && onChange) onChange();
+    return true;
+}
+
+bool SettingsStore::CheckForChanges() {
+    FILE_SIGNATURE fileSignature = GetFileSignature(path);
+    uint64_t startGeneration;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (fileSignature == signature) return false;
+        // Keep the last good settings while the file is missing, e.g. mid-replace
+        if (!fileSignature.exists) { signature = fileSignature; return false; }
+        startGeneration = generation;
+    }
+
+    if (IsSettling(fileSignature)) return false;
+
+    std::string data;
+    if (!ReadWholeFile(path, &data)) return false; // Locked by the writer; try again next pass
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (startGeneration != generation) return false;
+        signature = fileSignature;
+        if (data == currentData) return false;
+    }
+
+    // Parse outside the lock so Get never waits on it
+    auto settings = std::make_shared<Settings>();
+    ParseSettings(data, settings.get());
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (startGeneration != generation) return false;
+    current = std::move(settings);
+    currentData = std::move(data);
+    generation++;
+    return true;
+}
+
+void SettingsStore::StartWatching(std::function<void()> callback, unsigned intervalMs) {
+    if (watcher.joinable()) return;
+    onChange = std::move(callback);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = false;
+        pollMs = intervalMs ? intervalMs : 1000;
+    }
+    watcher = std::thread(&SettingsStore::Run, this);
+}
+
+void SettingsStore::StopWatching() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (watcher.joinable()) watcher.join();
+}
+
+void SettingsStore::Run() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!stopping) {
+        wake.wait_for(guard, std::chrono::milliseconds(pollMs), [this] { return stopping; });
+        if (stopping) break;
+        guard.unlock();
+        if (CheckForChanges() && onChange) onChange();
+        guard.lock();
+    }
+}
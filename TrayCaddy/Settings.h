@@ -0,0 +1,134 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// --- Settings ---
+// TrayCaddy.ini parsed once into an in-memory document. A published document
+// is never modified again; readers take a snapshot (a shared_ptr copy) and
+// keep using it while a newer one is swapped in behind them.
+
+struct SETTINGS_ENTRY {
+    std::wstring key;
+    std::wstring value;
+    std::wstring leading; // Comment and blank lines above the entry, kept for rewrites
+};
+
+struct SETTINGS_SECTION {
+    std::wstring name;
+    std::vector<SETTINGS_ENTRY> entries;
+    std::wstring leading;
+};
+
+class Settings {
+public:
+    // Section and key names are case-insensitive, like GetPrivateProfileString.
+    const std::wstring* Find(const std::wstring& section, const std::wstring& key) const;
+    const SETTINGS_SECTION* FindSection(const std::wstring& section) const;
+    const std::vector<SETTINGS_SECTION>& GetSections() const { return sections; }
+
+    std::wstring GetString(const std::wstring& section, const std::wstring& key, const std::wstring& defaultValue = L"") const;
+    // Decimal or 0x hex; defaultValue if missing or not a number.
+    int GetInt(const std::wstring& section, const std::wstring& key, int defaultValue) const;
+    // 1/0, true/false, yes/no, on/off.
+    bool GetBool(const std::wstring& section, const std::wstring& key, bool defaultValue) const;
+
+    void Set(const std::wstring& section, const std::wstring& key, const std::wstring& value);
+    void SetInt(const std::wstring& section, const std::wstring& key, int value);
+    void Remove(const std::wstring& section, const std::wstring& key);
+
+private:
+    friend void ParseSettings(const std::string& data, Settings* out);
+    friend std::string SerializeSettings(const Settings& settings);
+
+    size_t AddSection(const std::wstring& name);
+    bool AddEntry(size_t section, SETTINGS_ENTRY&& entry);
+    void Reindex();
+
+    std::vector<SETTINGS_SECTION> sections;
+    std::wstring trailing; // Comment lines after the last entry
+    std::unordered_map<std::wstring, size_t> sectionIndex;              // Lowercase name -> section
+    std::unordered_map<std::wstring, std::pair<size_t, size_t>> index;  // Lowercase "section\nkey" -> entry
+};
+
+typedef std::shared_ptr<const Settings> SETTINGS_SNAPSHOT;
+
+// Accepts UTF-8 (with or without BOM), UTF-16LE with BOM, and falls back to
+// Latin-1 for bytes that are not valid UTF-8, so old ANSI files still load.
+// Later duplicates of a key are ignored, as with GetPrivateProfileString.
+void ParseSettings(const std::string& data, Settings* out);
+
+// UTF-8 with CRLF line endings, in the original section and entry order.
+std::string SerializeSettings(const Settings& settings);
+
+// Writes to a temporary file next to path and renames it over path, so
+// readers see either the old or the new contents and never a partial file.
+bool WriteFileAtomic(const std::wstring& path, const std::string& data);
+
+// --- Settings Store ---
+// Owns the current snapshot for one file. The watcher thread polls the file's
+// size and timestamp, and only reads and parses when they change, so the UI
+// thread never waits on disk I/O or parsing; it is told via onChange and then
+// picks up the new snapshot with Get.
+
+struct FILE_SIGNATURE {
+    bool exists = false;
+    uint64_t size = 0;
+    int64_t writeTime = 0;
+
+    bool operator==(const FILE_SIGNATURE& other) const {
+        return exists == other.exists && size == other.size && writeTime == other.writeTime;
+    }
+    bool operator!=(const FILE_SIGNATURE& other) const { return !(*this == other); }
+};
+
+FILE_SIGNATURE GetFileSignature(const std::wstring& path);
+
+class SettingsStore {
+public:
+    explicit SettingsStore(std::wstring path);
+    ~SettingsStore();
+
+    // Reads and parses the file on the calling thread. A missing file yields
+    // an empty snapshot and returns false.
+    bool Load();
+    SETTINGS_SNAPSHOT Get() const;
+
+    // Applies edit to the newest settings, serializes them in one pass, writes
+    // them atomically and publishes them. The file is checked again under the
+    // store lock first: an outside edit the watcher has not picked up yet is
+    // parsed and edit applied on top of it instead of overwriting it, and
+    // onChange fires as for any outside edit. Returns false if nothing was written.
+    bool Save(const std::function<void(Settings*)>& edit);
+
+    void StartWatching(std::function<void()> onChange, unsigned pollMs = 1000);
+    void StopWatching();
+
+    // Runs one watcher pass on the calling thread. Returns true if a new
+    // snapshot was published; our own saves are recognised and skipped.
+    bool CheckForChanges();
+
+private:
+    void Run();
+
+    std::wstring path;
+
+    mutable std::mutex lock;
+    SETTINGS_SNAPSHOT current;
+    std::string currentData; // Bytes current was parsed from or saved as
+    FILE_SIGNATURE signature;
+    uint64_t generation = 0; // Bumped by Load/Save so a slower watcher pass cannot overwrite them
+
+    std::function<void()> onChange;
+    std::thread watcher;
+    std::condition_variable wake;
+    bool stopping = false;
+    unsigned pollMs = 1000;
+};
@@ -0,0 +1,100 @@
+#include "SimBackend.h"
+
+// --- Windows ---
+
+WINDOW_HANDLE SimWindowSystem::CreateSimWindow(const std::wstring& title, uint32_t processId, const std::wstring& className) {
+    WINDOW_HANDLE handle = nextHandle;
+    nextHandle += 4; // Real handles are never odd or adjacent
+    SIM_WINDOW& window = windows[handle];
+    window.title = title;
+    window.processId = processId;
+    window.className = className;
+    return handle;
+}
+
+void SimWindowSystem::DestroySimWindow(WINDOW_HANDLE window) {
+    windows.erase(window);
+    if (foreground == window) foreground = 0;
+}
+
+void SimWindowSystem::SetSimTitle(WINDOW_HANDLE window, const std::wstring& title) {
+    auto it = windows.find(window);
+    if (it != windows.end()) it->second.title = title;
+}
+
+const SIM_WINDOW* SimWindowSystem::Find(WINDOW_HANDLE window) const {
+    auto it = windows.find(window);
+    return it == windows.end() ? nullptr : &it->second;
+}
+
+bool SimWindowSystem::IsValidWindow(WINDOW_HANDLE window) { return windows.count(window) != 0; }
+
+std::wstring SimWindowSystem::GetTitle(WINDOW_HANDLE window) {
+    const SIM_WINDOW* w = Find(window);
+    return w ? w->title : std::wstring();
+}
+
+std::wstring SimWindowSystem::GetWindowClass(WINDOW_HANDLE window) {
+    const SIM_WINDOW* w = Find(window);
+    return w ? w->className : std::wstring();
+}
+
+uint32_t SimWindowSystem::GetOwnerProcess(WINDOW_HANDLE window) {
+    const SIM_WINDOW* w = Find(window);
+    return w ? w->processId : 0;
+}
+
+void SimWindowSystem::Hide(WINDOW_HANDLE window) {
+    auto it = windows.find(window);
+    if (it == windows.end()) return;
+    it->second.visible = false;
+    if (foreground == window) foreground = 0;
+}
+
+void SimWindowSystem::Restore(WINDOW_HANDLE window, bool activate) {
+    auto it = windows.find(window);
+    if (it == windows.end()) return;
+    it->second.visible = true;
+    if (activate) foreground = window;
+}
+
+// --- Tray ---
+
+bool SimTrayHost::AddIcon(unsigned iconId, WINDOW_HANDLE /*window*/, const std::wstring& tip) {
+    addCount++;
+    if (failAdds) { failCount++; return false; }
+    icons[iconId] = tip;
+    return true;
+}
+
+void SimTrayHost::RemoveIcon(unsigned iconId) { icons.erase(iconId); }
+
+bool SimTrayHost::ReaddIcon(unsigned iconId) {
+    addCount++;
+    if (failAdds || !icons.count(iconId)) { failCount++; return false; }
+    return true;
+}
+
+// --- Files ---
+
+bool SimFileSystem::ReadAll(const std::wstring& path, std::string* data) {
+    auto it = files.find(path);
+    if (it == files.end()) return false;
+    *data = it->second;
+    return true;
+}
+
+bool SimFileSystem::WriteAll(const std::wstring& path, const std::string& data) {
+    writeCount++;
+    bytesWritten += data.size();
+    files[path] = data;
+    return true;
+}
+
+// --- View ---
+
+void SimHiddenView::Refresh(const std::vector<HIDDEN_WINDOW>& items) {
+    refreshCount++;
+    rows.clear();
+    for (const auto& item : items) rows.push_back(item.title.empty() ? L"Unknown Window" : item.title);
+}
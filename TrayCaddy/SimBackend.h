@@ -0,0 +1,97 @@
+#pragma once
+
+#include "TrayCore.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// --- Simulated Backend ---
+// In-memory window system, tray, file system and view for driving the core
+// without a desktop, e.g. to time hide/restore/persistence at 100k windows.
+
+struct SIM_WINDOW {
+    std::wstring title;
+    std::wstring className = L"SimWindow";
+    uint32_t processId = 0;
+    bool visible = true;
+};
+
+class SimWindowSystem : public IWindowSystem {
+public:
+    WINDOW_HANDLE CreateSimWindow(const std::wstring& title, uint32_t processId = 0, const std::wstring& className = L"SimWindow");
+    void DestroySimWindow(WINDOW_HANDLE window);
+    void SetForeground(WINDOW_HANDLE window) { foreground = window; }
+    void SetSimTitle(WINDOW_HANDLE window, const std::wstring& title);
+    const SIM_WINDOW* Find(WINDOW_HANDLE window) const;
+    size_t Count() const { return windows.size(); }
+
+    bool IsValidWindow(WINDOW_HANDLE window) override;
+    WINDOW_HANDLE GetForeground() override { return foreground; }
+    std::wstring GetTitle(WINDOW_HANDLE window) override;
+    std::wstring GetWindowClass(WINDOW_HANDLE window) override;
+    uint32_t GetOwnerProcess(WINDOW_HANDLE window) override;
+    void Hide(WINDOW_HANDLE window) override;
+    void Restore(WINDOW_HANDLE window, bool activate) override;
+
+private:
+    std::unordered_map<WINDOW_HANDLE, SIM_WINDOW> windows;
+    WINDOW_HANDLE nextHandle = 0x10000;
+    WINDOW_HANDLE foreground = 0;
+};
+
+class SimTrayHost : public ITrayHost {
+public:
+    // While failAdds is set every AddIcon/ReaddIcon fails, like a tray that
+    // has not finished restarting.
+    bool failAdds = false;
+    size_t addCount = 0;
+    size_t failCount = 0;
+
+    bool AddIcon(unsigned iconId, WINDOW_HANDLE window, const std::wstring& tip) override;
+    void RemoveIcon(unsigned iconId) override;
+    bool ReaddIcon(unsigned iconId) override;
+    size_t Count() const { return icons.size(); }
+
+private:
+    std::unordered_map<unsigned, std::wstring> icons;
+};
+
+class SimFileSystem : public IFileSystem {
+public:
+    size_t writeCount = 0;
+    size_t bytesWritten = 0;
+
+    bool Exists(const std::wstring& path) override { return files.count(path) != 0; }
+    bool ReadAll(const std::wstring& path, std::string* data) override;
+    bool WriteAll(const std::wstring& path, const std::string& data) override;
+    void Remove(const std::wstring& path) override { files.erase(path); }
+
+private:
+    std::unordered_map<std::wstring, std::string> files;
+};
+
+// Mirrors what UpdateListView does per refresh: one row per hidden window
+// with its display title.
+class SimHiddenView : public IHiddenView {
+public:
+    size_t refreshCount = 0;
+    std::vector<std::wstring> rows;
+
+    void Refresh(const std::vector<HIDDEN_WINDOW>& items) override;
+};
+
+// The four simulated pieces together, for tests and benchmarks.
+struct SIM_BACKEND {
+    SimWindowSystem windows;
+    SimTrayHost tray;
+    SimFileSystem files;
+    SimHiddenView view;
+
+    void Attach(CORE_STATE* core) {
+        core->windows = &windows;
+        core->tray = &tray;
+        core->files = &files;
+        core->view = &view;
+    }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <list>
+#include <unordered_map>
+
+// --- Thumbnails ---
+// Snapshots are stored as RGB565 (2 bytes per pixel), which keeps a 256x160
+// preview at 80 KB and can be blitted directly with a BI_BITFIELDS DIB. Rows
+// are padded to an even pixel count to meet the DIB DWORD row alignment.
+
+struct THUMBNAIL {
+    int width = 0;
+    int height = 0;
+    int stride = 0; // pixels per row
+    std::vector<uint16_t> pixels;
+
+    size_t Bytes() const { return pixels.size() * sizeof(uint16_t); }
+};
+
+// Largest size that fits maxW x maxH with the source aspect ratio. Never upscales.
+void FitThumbnailSize(int srcW, int srcH, int maxW, int maxH, int* outW, int* outH);
+
+// Box-filter downscale of a top-down 32-bit BGRA image into RGB565. Each
+// destination pixel averages the source rectangle it covers. srcStride is in
+// bytes, dstStride in pixels.
+// DownscaleBox accumulates whole rows so the compiler can vectorize it; the
+// scalar version sums each box directly and is the reference it must match
+// bit for bit.
+void DownscaleBox(const uint8_t* src, int srcW, int srcH, size_t srcStride, uint16_t* dst, int dstW, int dstH, size_t dstStride);
+void DownscaleBoxScalar(const uint8_t* src, int srcW, int srcH, size_t srcStride, uint16_t* dst, int dstW, int dstH, size_t dstStride);
+
+// Convenience wrapper that sizes and fills a THUMBNAIL.
+bool MakeThumbnail(const uint8_t* src, int srcW, int srcH, size_t srcStride, int maxW, int maxH, THUMBNAIL* out);
+
+// Least-recently-used thumbnail store with a hard byte budget. Inserting past
+// the budget evicts the oldest entries; a single entry larger than the whole
+// budget is rejected.
+class ThumbnailCache {
+public:
+    explicit ThumbnailCache(size_t budgetBytes) : budget(budgetBytes) {}
+
+    bool Put(unsigned key, THUMBNAIL&& thumb);
+    const THUMBNAIL* Get(unsigned key); // Marks the entry as most recently used
+    void Remove(unsigned key);
+    void Clear();
+    void SetBudget(size_t budgetBytes);
+
+    size_t Bytes() const { return used; }
+    size_t Count() const { return entries.size(); }
+
+private:
+    struct ENTRY {
+        THUMBNAIL thumb;
+        std::list<unsigned>::iterator order;
+    };
+
+    void EvictTo(size_t limit);
+
+    size_t budget;
+    size_t used = 0;
+    std::list<unsigned> order; // Front is most recently used
+    std::unordered_map<unsigned, ENTRY> entries;
+};
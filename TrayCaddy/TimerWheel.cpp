@@ -0,0 +1,151 @@
+#include "TimerWheel.h"
+
+#include <bit>
+
+#define WHEEL_NIL       UINT32_MAX
+#define WHEEL_SLOT_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_SPAN      (1ull << (WHEEL_LEVELS * WHEEL_SLOT_BITS)) // Ticks covered by all levels
+
+TimerWheel::TimerWheel(uint64_t startTick) : freeList(WHEEL_NIL), nextTick(startTick + 1) {
+    for (auto& level : heads) {
+        for (auto& head : level) head = WHEEL_NIL;
+    }
+}
+
+// --- Slot Lists ---
+
+void TimerWheel::Link(uint32_t index) {
+    TIMER_NODE& node = nodes[index];
+    uint64_t expires = node.expires < nextTick ? nextTick : node.expires;
+    uint64_t delta = expires - nextTick;
+    if (delta >= WHEEL_SPAN) expires = nextTick + WHEEL_SPAN - 1; // Parked in the last level until it comes in range
+
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= (1ull << ((level + 1) * WHEEL_SLOT_BITS))) level++;
+    unsigned slot = (unsigned)(expires >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK;
+
+    node.level = (uint8_t)level;
+    node.slot = (uint8_t)slot;
+    node.prev = WHEEL_NIL;
+    node.next = heads[level][slot];
+    if (node.next != WHEEL_NIL) nodes[node.next].prev = index;
+    heads[level][slot] = index;
+    occupied[level] |= 1ull << slot;
+}
+
+void TimerWheel::Unlink(uint32_t index) {
+    TIMER_NODE& node = nodes[index];
+    if (node.prev != WHEEL_NIL) nodes[node.prev].next = node.next;
+    else heads[node.level][node.slot] = node.next;
+    if (node.next != WHEEL_NIL) nodes[node.next].prev = node.prev;
+    if (heads[node.level][node.slot] == WHEEL_NIL) occupied[node.level] &= ~(1ull << node.slot);
+}
+
+void TimerWheel::Release(uint32_t index) {
+    TIMER_NODE& node = nodes[index];
+    node.active = false;
+    if (++node.generation == 0) node.generation = 1; // Keeps ids non-zero
+    node.next = freeList;
+    freeList = index;
+    count--;
+}
+
+// Re-files every timer in a coarse slot; they land one or more levels down.
+void TimerWheel::Cascade(int level, unsigned slot) {
+    uint32_t index = heads[level][slot];
+    heads[level][slot] = WHEEL_NIL;
+    occupied[level] &= ~(1ull << slot);
+    while (index != WHEEL_NIL) {
+        uint32_t next = nodes[index].next;
+        Link(index);
+        index = next;
+    }
+}
+
+// --- Timers ---
+
+TIMER_ID TimerWheel::Schedule(uint64_t tick, uint64_t userData) {
+    uint32_t index;
+    if (freeList != WHEEL_NIL) {
+        index = freeList;
+        freeList = nodes[index].next;
+    }
+    else {
+        index = (uint32_t)nodes.size();
+        nodes.emplace_back();
+    }
+
+    TIMER_NODE& node = nodes[index];
+    node.expires = tick;
+    node.userData = userData;
+    node.active = true;
+    Link(index);
+    count++;
+    return ((uint64_t)node.generation << 32) | index;
+}
+
+bool TimerWheel::Cancel(TIMER_ID id) {
+    uint32_t index = (uint32_t)id;
+    if (index >= nodes.size()) return false;
+    TIMER_NODE& node = nodes[index];
+    if (!node.active || node.generation != (uint32_t)(id >> 32)) return false;
+    Unlink(index);
+    Release(index);
+    return true;
+}
+
+void TimerWheel::Advance(uint64_t nowTick, std::vector<TIMER_EXPIRY>* expired) {
+    while (nextTick <= nowTick) {
+        if (count == 0) { nextTick = nowTick + 1; break; }
+
+        unsigned index = (unsigned)nextTick & WHEEL_SLOT_MASK;
+        if (index == 0) {
+            // Level 0 wrapped: bring down the next slot of each coarser level
+            // whose own index wrapped as well.
+            for (int level = 1; level < WHEEL_LEVELS; level++) {
+                unsigned slot = (unsigned)(nextTick >> (level * WHEEL_SLOT_BITS)) & WHEEL_SLOT_MASK;
+                Cascade(level, slot);
+                if (slot != 0) break;
+            }
+        }
+        else if ((occupied[0] >> index) == 0) {
+            // Nothing left in this rotation; jump to the wrap
+            uint64_t wrap = (nextTick | WHEEL_SLOT_MASK) + 1;
+            nextTick = wrap <= nowTick ? wrap : nowTick + 1;
+            continue;
+        }
+
+        uint32_t node = heads[0][index];
+        heads[0][index] = WHEEL_NIL;
+        occupied[0] &= ~(1ull << index);
+        while (node != WHEEL_NIL) {
+            uint32_t next = nodes[node].next;
+            expired->push_back({ ((uint64_t)nodes[node].generation << 32) | node, nodes[node].userData });
+            Release(node);
+            node = next;
+        }
+        nextTick++;
+    }
+}
+
+uint64_t TimerWheel::NextTick() const {
+    if (count == 0) return WHEEL_NO_TIMER;
+
+    uint64_t best = WHEEL_NO_TIMER;
+    unsigned index = (unsigned)nextTick & WHEEL_SLOT_MASK;
+    if (occupied[0]) {
+        uint64_t rotated = std::rotr(occupied[0], (int)index); // Bit 0 is now the slot for nextTick
+        best = nextTick + (uint64_t)std::countr_zero(rotated);
+    }
+    for (int level = 1; level < WHEEL_LEVELS; level++) {
+        if (!occupied[level]) continue;
+        // A coarse slot is re-filed on the first tick of its span; find the
+        // first occupied one from the next span boundary on
+        int shift = level * WHEEL_SLOT_BITS;
+        uint64_t boundary = (nextTick + (1ull << shift) - 1) >> shift;
+        uint64_t rotated = std::rotr(occupied[level], (int)(boundary & WHEEL_SLOT_MASK));
+        uint64_t cascade = (boundary + (uint64_t)std::countr_zero(rotated)) << shift;
+        if (cascade < best) best = cascade;
+    }
+    return best;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// --- Timer Wheel ---
+// Hierarchical timing wheel: four levels of 64 slots, each level 64 times
+// coarser than the one below. Timers sit in intrusive lists inside a node
+// pool, so scheduling and cancelling are O(1). Advancing costs one slot
+// visit per tick plus re-filing far timers as their slot comes up; runs of
+// empty level 0 slots are skipped using the occupancy bitmap.
+//
+// Ticks are abstract; the caller decides what one tick means.
+
+#define WHEEL_LEVELS    4
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS     (1 << WHEEL_SLOT_BITS)
+#define WHEEL_NO_TIMER  UINT64_MAX
+
+typedef uint64_t TIMER_ID; // 0 is never a valid id
+
+struct TIMER_EXPIRY {
+    TIMER_ID id;
+    uint64_t userData;
+};
+
+class TimerWheel {
+public:
+    explicit TimerWheel(uint64_t startTick = 0);
+
+    // Fires on the first Advance that reaches tick; ticks already passed fire
+    // on the next one. Ticks beyond the wheel's range (64^4) are re-filed
+    // until they come within it.
+    TIMER_ID Schedule(uint64_t tick, uint64_t userData);
+    // Returns false if the timer already fired or was cancelled.
+    bool Cancel(TIMER_ID id);
+
+    // Processes every tick up to and including nowTick and appends the timers
+    // that came due, in expiry order.
+    void Advance(uint64_t nowTick, std::vector<TIMER_EXPIRY>* expired);
+
+    // Earliest tick worth advancing to: exact when the next timer is within
+    // 64 ticks, otherwise the next tick that re-files an occupied far slot.
+    // WHEEL_NO_TIMER when nothing is scheduled.
+    uint64_t NextTick() const;
+
+    uint64_t GetCurrentTick() const { return nextTick - 1; }
+    size_t Count() const { return count; }
+
+private:
+    struct TIMER_NODE {
+        uint64_t expires = 0;
+        uint64_t userData = 0;
+        uint32_t prev = 0;
+        uint32_t next = 0;
+        uint32_t generation = 1;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool active = false;
+    };
+
+    void Link(uint32_t index);
+    void Unlink(uint32_t index);
+    void Release(uint32_t index);
+    void Cascade(int level, unsigned slot);
+
+    std::vector<TIMER_NODE> nodes;
+    uint32_t freeList;
+    uint32_t heads[WHEEL_LEVELS][WHEEL_SLOTS];
+    uint64_t occupied[WHEEL_LEVELS] = {}; // Bit per non-empty slot
+    uint64_t nextTick; // First tick not yet processed
+    size_t count = 0;
+};
@@ -0,0 +1,111 @@
+#include "TraceReplay.h"
+#include "SimBackend.h"
+#include "resource.h"
+
+#include <thread>
+#include <unordered_map>
+
+// --- Replay ---
+
+TRACE_REPLAY_STATS ReplayTrace(const std::vector<TRACE_EVENT>& events, CORE_STATE* core, SIM_BACKEND* sim, TRACE_PACING pacing) {
+    TRACE_REPLAY_STATS stats;
+    SimWindowSystem* windows = &sim->windows;
+    std::unordered_map<uint64_t, WINDOW_HANDLE> handles; // Recorded handle -> simulated handle
+    std::unordered_map<uint32_t, unsigned> iconIds;      // Recorded icon id -> replayed icon id
+    bool refreshPending = false;
+
+    auto createWindow = [&](const TRACE_EVENT& event) {
+        return event.className.empty() ? windows->CreateSimWindow(event.text, event.param2)
+                                       : windows->CreateSimWindow(event.text, event.param2, event.className);
+    };
+    auto mapWindow = [&](const TRACE_EVENT& event, bool create) -> WINDOW_HANDLE {
+        auto it = handles.find(event.window);
+        if (it != handles.end()) return it->second;
+        if (!create || !event.window) return 0;
+        WINDOW_HANDLE handle = createWindow(event);
+        handles[event.window] = handle;
+        return handle;
+    };
+    // Hides with their recorded outcome; param is the icon id, 0 if the window stayed
+    auto replayHide = [&](const TRACE_EVENT& event, WINDOW_HANDLE window, bool persist) {
+        // Shell windows are still rejected by their recorded class; any other
+        // recorded failure (own window, tray not ready) is replayed at the tray
+        bool addFails = sim->tray.failAdds;
+        if (!event.param) sim->tray.failAdds = true;
+        bool hidden = window && MinimizeToTray(core, window, persist);
+        sim->tray.failAdds = addFails;
+        if (hidden) {
+            stats.hides++;
+            if (event.param) iconIds[event.param] = core->hiddenWindows.back().iconId;
+        }
+        if (hidden != (event.param != 0)) stats.mismatches++;
+        return hidden;
+    };
+    auto replayRestore = [&](uint32_t recordedIconId) {
+        auto it = iconIds.find(recordedIconId);
+        if (it == iconIds.end() || !FindHiddenWindow(core, it->second)) return;
+        RestoreWindow(core, it->second);
+        stats.restores++;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& event : events) {
+        if (pacing == PACING_REAL_TIME) std::this_thread::sleep_until(start + std::chrono::microseconds(event.timeUs));
+
+        // Hide events come in batches (startup, auto-hide); the list is refreshed once after them
+        if (refreshPending && event.type != TRACE_HIDE) {
+            if (core->view) core->view->Refresh(core->hiddenWindows);
+            refreshPending = false;
+        }
+
+        switch (event.type) {
+        case TRACE_HOTKEY: {
+            WINDOW_HANDLE window = mapWindow(event, true);
+            windows->SetForeground(window);
+            replayHide(event, window, true);
+            break;
+        }
+        case TRACE_HIDE: {
+            WINDOW_HANDLE window = mapWindow(event, true);
+            if (replayHide(event, window, false)) refreshPending = true;
+            break;
+        }
+        case TRACE_TRAY_ICON:
+            if (event.param2 == TRACE_MOUSE_DBLCLK) replayRestore(event.param);
+            break;
+        case TRACE_RESTORE:
+            replayRestore(event.param);
+            break;
+        case TRACE_COMMAND:
+            if (event.param == ID_BTN_RESTORE_ALL || event.param == ID_MENU_RESTORE_ALL) {
+                stats.restores += core->hiddenWindows.size();
+                RestoreAll(core);
+            }
+            break;
+        case TRACE_TASKBAR_CREATED:
+            ReaddHiddenIcons(core);
+            break;
+        case TRACE_WINDOW_CREATED: {
+            // A recycled handle refers to a new window
+            auto it = handles.find(event.window);
+            if (it != handles.end()) windows->DestroySimWindow(it->second);
+            handles[event.window] = createWindow(event);
+            break;
+        }
+        case TRACE_WINDOW_DESTROYED: {
+            auto it = handles.find(event.window);
+            if (it != handles.end()) { windows->DestroySimWindow(it->second); handles.erase(it); }
+            break;
+        }
+        case TRACE_WINDOW_TITLE: {
+            WINDOW_HANDLE window = mapWindow(event, false);
+            if (window) windows->SetSimTitle(window, event.text);
+            break;
+        }
+        }
+        stats.events++;
+    }
+    if (refreshPending && core->view) core->view->Refresh(core->hiddenWindows);
+    stats.elapsed = std::chrono::steady_clock::now() - start;
+    return stats;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "EventTrace.h"
+#include "TrayCore.h"
+
+#include <chrono>
+#include <vector>
+
+struct SIM_BACKEND;
+
+// --- Trace Replay ---
+// Drives the core with a recorded trace (EventTrace.h) on the simulated
+// backend, for regression tests and benchmarks. Not part of the app.
+
+enum TRACE_PACING {
+    PACING_FULL_SPEED, // Back to back, for throughput
+    PACING_REAL_TIME,  // Sleeps to reproduce the recorded gaps
+};
+
+struct TRACE_REPLAY_STATS {
+    size_t events = 0;
+    size_t hides = 0;
+    size_t restores = 0;
+    size_t mismatches = 0; // Hotkey or hide events whose outcome differed from the recording
+    std::chrono::nanoseconds elapsed{ 0 };
+};
+
+// The core must be attached to sim. Recorded window handles are mapped to
+// simulated windows of the recorded class; handles first seen in a hotkey or
+// hide event are created on demand, since they existed before recording
+// started. Recorded icon ids are mapped to the ids the replay assigned, and a
+// hotkey that failed to add its icon when recorded fails the same way here.
+TRACE_REPLAY_STATS ReplayTrace(const std::vector<TRACE_EVENT>& events, CORE_STATE* core, SIM_BACKEND* sim, TRACE_PACING pacing);
@@ -0,0 +1,177 @@
+#include "TrayCore.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+// --- Metrics ---
+
+static void Count(Counter* counter, uint64_t n = 1) { if (counter) counter->Add(n); }
+
+static void UpdateHiddenGauge(CORE_STATE* core) {
+    if (core->metrics.hiddenWindows) core->metrics.hiddenWindows->Set((int64_t)core->hiddenWindows.size());
+}
+
+void RegisterCoreMetrics(MetricsRegistry* registry, CORE_METRICS* metrics) {
+    const double us = 1e-6;
+    metrics->hiddenWindows = registry->AddGauge("traycaddy_hidden_windows", "Windows currently hidden to the tray.");
+    metrics->hides = registry->AddCounter("traycaddy_hides_total", "Windows hidden to the tray.");
+    metrics->hideFailures = registry->AddCounter("traycaddy_hide_failures_total", "Hides abandoned because the tray icon could not be added.");
+    metrics->restores = registry->AddCounter("traycaddy_restores_total", "Windows restored from the tray.");
+    metrics->hideLatency = registry->AddHistogram("traycaddy_hide_duration_seconds", "Time to hide one window, including the state save.", LatencyBucketsUs(), us);
+    metrics->restoreLatency = registry->AddHistogram("traycaddy_restore_duration_seconds", "Time to restore one window, including the state save.", LatencyBucketsUs(), us);
+    metrics->saves = registry->AddCounter("traycaddy_state_saves_total", "Writes of the hidden window list.");
+    metrics->saveFailures = registry->AddCounter("traycaddy_state_save_failures_total", "Writes of the hidden window list that failed.");
+    metrics->saveBytes = registry->AddGauge("traycaddy_state_save_bytes", "Size of the last hidden window list written.");
+    metrics->saveLatency = registry->AddHistogram("traycaddy_state_save_duration_seconds", "Time to write the hidden window list.", LatencyBucketsUs(), us);
+    metrics->trayReadds = registry->AddCounter("traycaddy_tray_readds_total", "Tray icons re-registered after the taskbar was recreated.");
+    metrics->trayReaddFailures = registry->AddCounter("traycaddy_tray_readd_failures_total", "Tray icons that could not be re-registered.");
+}
+
+// --- Hide / Restore ---
+
+bool MinimizeToTray(CORE_STATE* core, WINDOW_HANDLE targetWindow, bool persist) {
+    static const wchar_t* restrictWins[] = { L"WorkerW", L"Shell_TrayWnd", L"Progman" };
+    WINDOW_HANDLE currWin = targetWindow ? targetWindow : core->windows->GetForeground();
+    if (!currWin || !core->windows->IsValidWindow(currWin) || currWin == core->ownWindow) return false;
+
+    std::wstring className = core->windows->GetWindowClass(currWin);
+    for (const auto& restricted : restrictWins) if (className == restricted) return false;
+
+    HistogramTimer timer(core->metrics.hideLatency);
+    HIDDEN_WINDOW item;
+    item.window = currWin;
+    item.iconId = core->nextHiddenIconId++;
+    item.title = core->windows->GetTitle(currWin);
+    item.processId = core->windows->GetOwnerProcess(currWin);
+    if (!core->tray->AddIcon(item.iconId, currWin, item.title)) { Count(core->metrics.hideFailures); return false; }
+
+    if (core->view) core->view->OnWindowHiding(item);
+    core->windows->Hide(currWin);
+    core->hiddenWindows.push_back(std::move(item));
+    if (persist) {
+        SaveState(core);
+        if (core->view) core->view->Refresh(core->hiddenWindows);
+    }
+    Count(core->metrics.hides);
+    UpdateHiddenGauge(core);
+    return true;
+}
+
+void RestoreWindow(CORE_STATE* core, unsigned iconId) {
+    auto it = std::find_if(core->hiddenWindows.begin(), core->hiddenWindows.end(),
+        [&](const HIDDEN_WINDOW& item) { return item.iconId == iconId; });
+    if (it == core->hiddenWindows.end()) return;
+
+    HistogramTimer timer(core->metrics.restoreLatency);
+    if (it->window && core->windows->IsValidWindow(it->window)) core->windows->Restore(it->window, true);
+    core->tray->RemoveIcon(it->iconId);
+    if (core->view) core->view->OnWindowRestored(*it);
+    core->hiddenWindows.erase(it);
+    SaveState(core);
+    if (core->view) core->view->Refresh(core->hiddenWindows);
+    Count(core->metrics.restores);
+    UpdateHiddenGauge(core);
+}
+
+void RestoreAll(CORE_STATE* core) {
+    for (const auto& item : core->hiddenWindows) {
+        if (item.window && core->windows->IsValidWindow(item.window)) core->windows->Restore(item.window, false);
+        core->tray->RemoveIcon(item.iconId);
+        if (core->view) core->view->OnWindowRestored(item);
+    }
+    Count(core->metrics.restores, core->hiddenWindows.size());
+    core->hiddenWindows.clear();
+    UpdateHiddenGauge(core);
+    SaveState(core);
+    if (core->view) core->view->Refresh(core->hiddenWindows);
+}
+
+void ReaddHiddenIcons(CORE_STATE* core) {
+    // Windows that were closed while hidden are dropped instead of re-added
+    auto gone = std::stable_partition(core->hiddenWindows.begin(), core->hiddenWindows.end(),
+        [&](const HIDDEN_WINDOW& item) { return item.window && core->windows->IsValidWindow(item.window); });
+    for (auto it = gone; it != core->hiddenWindows.end(); ++it) {
+        core->tray->RemoveIcon(it->iconId);
+        if (core->view) core->view->OnWindowRestored(*it);
+    }
+    core->hiddenWindows.erase(gone, core->hiddenWindows.end());
+
+    for (const auto& item : core->hiddenWindows) {
+        Count(core->metrics.trayReadds);
+        if (!core->tray->ReaddIcon(item.iconId)) Count(core->metrics.trayReaddFailures);
+    }
+    UpdateHiddenGauge(core);
+    if (core->view) core->view->Refresh(core->hiddenWindows);
+}
+
+const HIDDEN_WINDOW* FindHiddenWindow(const CORE_STATE* core, unsigned iconId) {
+    for (const auto& item : core->hiddenWindows) if (item.iconId == iconId) return &item;
+    return nullptr;
+}
+
+// --- Persistence ---
+// One window handle per line, in decimal.
+
+void SaveState(const CORE_STATE* core) {
+    HistogramTimer timer(core->metrics.saveLatency);
+    Count(core->metrics.saves);
+    if (core->hiddenWindows.empty()) {
+        core->files->Remove(core->saveFile);
+        if (core->metrics.saveBytes) core->metrics.saveBytes->Set(0);
+        return;
+    }
+    std::string data;
+    for (const auto& item : core->hiddenWindows) {
+        if (item.window && core->windows->IsValidWindow(item.window)) {
+            data += std::to_string((unsigned long long)item.window);
+            data += '\n';
+        }
+    }
+    if (core->metrics.saveBytes) core->metrics.saveBytes->Set((int64_t)data.size());
+    if (!core->files->WriteAll(core->saveFile, data)) Count(core->metrics.saveFailures);
+}
+
+void LoadState(CORE_STATE* core) {
+    std::string data;
+    if (!core->files->Exists(core->saveFile) || !core->files->ReadAll(core->saveFile, &data)) return;
+
+    const char* p = data.c_str();
+    while (*p) {
+        char* end = nullptr;
+        unsigned long long val = strtoull(p, &end, 10);
+        if (end != p && val != 0 && core->windows->IsValidWindow((WINDOW_HANDLE)val)) MinimizeToTray(core, (WINDOW_HANDLE)val, false);
+        p = end != p ? end : p + 1;
+        while (*p == '\r' || *p == '\n') p++;
+    }
+    if (core->view) core->view->Refresh(core->hiddenWindows);
+}
+
+// --- Disk File System ---
+
+bool DiskFileSystem::Exists(const std::wstring& path) {
+    std::error_code ec;
+    return std::filesystem::exists(std::filesystem::path(path), ec);
+}
+
+bool DiskFileSystem::ReadAll(const std::wstring& path, std::string* data) {
+    std::ifstream file(std::filesystem::path(path), std::ios::binary);
+    if (!file.is_open()) return false;
+    data->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool DiskFileSystem::WriteAll(const std::wstring& path, const std::string& data) {
+    std::ofstream file(std::filesystem::path(path), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(data.data(), (std::streamsize)data.size());
+    return (bool)file;
+}
+
+void DiskFileSystem::Remove(const std::wstring& path) {
+    std::error_code ec;
+    std::filesystem::remove(std::filesystem::path(path), ec);
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// --- Core ---
+// Hide/restore bookkeeping and persistence, independent of Win32. The
+// platform is reached only through the interfaces below; main.cpp provides
+// the Win32 backend and SimBackend.h an in-memory one. Method names avoid
+// the Win32 API names so they are not rewritten by the A/W macros.
+
+typedef uintptr_t WINDOW_HANDLE; // HWND value on Windows
+
+struct HIDDEN_WINDOW {
+    WINDOW_HANDLE window = 0;
+    unsigned iconId = 0;
+    std::wstring title;
+    uint32_t processId = 0;
+};
+
+class IWindowSystem {
+public:
+    virtual ~IWindowSystem() = default;
+    virtual bool IsValidWindow(WINDOW_HANDLE window) = 0;
+    virtual WINDOW_HANDLE GetForeground() = 0;
+    virtual std::wstring GetTitle(WINDOW_HANDLE window) = 0;
+    virtual std::wstring GetWindowClass(WINDOW_HANDLE window) = 0;
+    virtual uint32_t GetOwnerProcess(WINDOW_HANDLE window) = 0;
+    virtual void Hide(WINDOW_HANDLE window) = 0;
+    virtual void Restore(WINDOW_HANDLE window, bool activate) = 0;
+};
+
+class ITrayHost {
+public:
+    virtual ~ITrayHost() = default;
+    // Adds the notification icon for a window that is about to be hidden.
+    virtual bool AddIcon(unsigned iconId, WINDOW_HANDLE window, const std::wstring& tip) = 0;
+    virtual void RemoveIcon(unsigned iconId) = 0;
+    // Re-registers an existing icon after the taskbar was recreated.
+    virtual bool ReaddIcon(unsigned iconId) = 0;
+};
+
+class IFileSystem {
+public:
+    virtual ~IFileSystem() = default;
+    virtual bool Exists(const std::wstring& path) = 0;
+    virtual bool ReadAll(const std::wstring& path, std::string* data) = 0;
+    virtual bool WriteAll(const std::wstring& path, const std::string& data) = 0;
+    virtual void Remove(const std::wstring& path) = 0;
+};
+
+// Presentation of the hidden list (list view, previews).
+class IHiddenView {
+public:
+    virtual ~IHiddenView() = default;
+    virtual void OnWindowHiding(const HIDDEN_WINDOW& /*item*/) {} // Window is still on screen
+    virtual void OnWindowRestored(const HIDDEN_WINDOW& /*item*/) {}
+    virtual void Refresh(const std::vector<HIDDEN_WINDOW>& items) = 0;
+};
+
+class Counter;
+class Gauge;
+class Histogram;
+class MetricsRegistry;
+
+// Instrumentation of the core paths (see Metrics.h); null members are skipped.
+struct CORE_METRICS {
+    Gauge* hiddenWindows = nullptr;
+    Counter* hides = nullptr;
+    Counter* hideFailures = nullptr; // Tray refused the icon
+    Counter* restores = nullptr;
+    Histogram* hideLatency = nullptr;
+    Histogram* restoreLatency = nullptr;
+    Counter* saves = nullptr;
+    Counter* saveFailures = nullptr;
+    Gauge* saveBytes = nullptr;
+    Histogram* saveLatency = nullptr;
+    Counter* trayReadds = nullptr;
+    Counter* trayReaddFailures = nullptr;
+};
+
+struct CORE_STATE {
+    IWindowSystem* windows = nullptr;
+    ITrayHost* tray = nullptr;
+    IFileSystem* files = nullptr;
+    IHiddenView* view = nullptr;
+
+    WINDOW_HANDLE ownWindow = 0;
+    std::wstring saveFile = L"TrayCaddy.dat";
+    std::vector<HIDDEN_WINDOW> hiddenWindows;
+    unsigned nextHiddenIconId = 1000;
+    CORE_METRICS metrics;
+};
+
+// Hides targetWindow, or the foreground window when it is 0. Batches such as
+// LoadState pass persist = false: the save file is already current and the
+// caller refreshes the view once at the end instead of once per window.
+bool MinimizeToTray(CORE_STATE* core, WINDOW_HANDLE targetWindow = 0, bool persist = true);
+void RestoreWindow(CORE_STATE* core, unsigned iconId);
+void RestoreAll(CORE_STATE* core);
+void ReaddHiddenIcons(CORE_STATE* core);
+void SaveState(const CORE_STATE* core);
+void LoadState(CORE_STATE* core);
+const HIDDEN_WINDOW* FindHiddenWindow(const CORE_STATE* core, unsigned iconId);
+
+// Creates the traycaddy_* core metrics in registry and points metrics at them.
+void RegisterCoreMetrics(MetricsRegistry* registry, CORE_METRICS* metrics);
+
+// std::filesystem backed IFileSystem, shared by every platform.
+class DiskFileSystem : public IFileSystem {
+public:
+    bool Exists(const std::wstring& path) override;
+    bool ReadAll(const std::wstring& path, std::string* data) override;
+    bool WriteAll(const std::wstring& path, const std::string& data) override;
+    void Remove(const std::wstring& path) override;
+};
@@ -14,9 +14,20 @@ processorArchitecture='*' publicKeyToken='6595b64144ccf1df' language='*'\"")
 #include <ShellScalingApi.h>
 #include <string>
 #include <vector>
-#include <fstream>
 #include <algorithm>
-#include <filesystem>
+#include <climits>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include "resource.h"
+#include "TrayCore.h"
+#include "ProcessStats.h"
+#include "Thumbnail.h"
+#include "EventTrace.h"
+#include "HotkeyNames.h"
+#include "Settings.h"
+#include "AutoHide.h"
+#include "Metrics.h"
 
 // Link necessary libraries
 #pragma comment(lib, "user32.lib")
@@ -30,24 +41,37 @@ processorArchitecture='*' publicKeyToken='6595b64144ccf1df' language='*'\"")
 #define WM_OURICON  0x1C0B
 #define HOTKEY_ID   1
 
+// Timers
+#define ID_TIMER_PREVIEW  1
+#define ID_TIMER_AUTOHIDE 2
+#define ID_TIMER_TRACE    3
+
+// Hover previews
+#define THUMB_MAX_W    256
+#define THUMB_MAX_H    160
+#define PREVIEW_BORDER 4
+#define THUMB_BUDGET_MAX_KB (256 * 1024) // ThumbnailBudgetKB is clamped to 0 (no previews cached) .. 256 MB
+
+#ifndef PW_RENDERFULLCONTENT
+#define PW_RENDERFULLCONTENT 0x00000002
+#endif
+
 // Custom messages
 #define WM_UPDATE_HOTKEY (WM_USER + 1)
 #define WM_PAUSE_HOTKEY  (WM_USER + 2)
 #define WM_RESUME_HOTKEY (WM_USER + 3)
+#define WM_STATS_UPDATED (WM_USER + 4)
+#define WM_SETTINGS_CHANGED (WM_USER + 5)
 
-// Control IDs
-#define ID_BTN_RESTORE_ALL    0x200
-#define ID_LIST_WINDOWS       0x202
-#define ID_HK_CONTROL         0x203
-#define ID_LBL_CURRENT_HK     0x204
-#define ID_BTN_MENU           0x205 
-#define ID_BTN_CLOSE_SETTINGS 0x206 
-#define ID_LBL_INSTR          0x208
-#define ID_LBL_SETTINGS_TITLE 0x209 
+// List columns
+#define COL_TITLE  0
+#define COL_CPU    1
+#define COL_MEMORY 2
 
-#define ID_MENU_RESTORE_ALL   0x98
-#define ID_MENU_EXIT          0x99
-#define ID_MENU_OPEN_PREFS    0x100 
+// Sort modes
+#define SORT_BY_HIDDEN 0 // Order in which windows were hidden
+#define SORT_BY_CPU    1
+#define SORT_BY_MEMORY 2
 
 // --- MODERN DARK PALETTE ---
 const COLORREF CLR_BG_DARK = RGB(30, 30, 30);
@@ -66,21 +90,68 @@ const COLORREF CLR_ICON_HOVER = RGB(55, 55, 55);
 const std::wstring SAVE_FILE = L"TrayCaddy.dat";
 const std::wstring SETTINGS_FILE = L"TrayCaddy.ini";
 
-// --- Data Structures ---
+// The settings and the hidden-window list live next to TrayCaddy.exe, whatever
+// the working directory of the shortcut or autostart entry that launched it.
+std::wstring GetAppFilePath(const std::wstring& fileName) {
+    wchar_t exePath[MAX_PATH];
+    DWORD len = GetModuleFileName(NULL, exePath, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH) return fileName;
+    std::wstring path(exePath, len);
+    size_t slash = path.find_last_of(L"\\/");
+    return slash == std::wstring::npos ? fileName : path.substr(0, slash + 1) + fileName;
+}
 
-struct HIDDEN_WINDOW {
-    NOTIFYICONDATA icon = { 0 };
-    HWND window = nullptr;
-    UINT iconId = 0;
-    std::wstring title;
-    HICON hWindowIcon = nullptr;
-};
+// --- Data Structures ---
 
 struct CUSTOM_HOTKEY_DATA {
     UINT modifiers;
     UINT vKey;
 };
 
+struct APP_STATE;
+
+// --- Win32 Backend ---
+// Platform side of the interfaces in TrayCore.h.
+
+class Win32WindowSystem : public IWindowSystem {
+public:
+    bool IsValidWindow(WINDOW_HANDLE window) override;
+    WINDOW_HANDLE GetForeground() override;
+    std::wstring GetTitle(WINDOW_HANDLE window) override;
+    std::wstring GetWindowClass(WINDOW_HANDLE window) override;
+    uint32_t GetOwnerProcess(WINDOW_HANDLE window) override;
+    void Hide(WINDOW_HANDLE window) override;
+    void Restore(WINDOW_HANDLE window, bool activate) override;
+};
+
+struct TRAY_ENTRY {
+    NOTIFYICONDATA icon = { 0 };
+    HICON hWindowIcon = nullptr; // Copy owned by the entry, used by the list view
+};
+
+class Win32TrayHost : public ITrayHost {
+public:
+    HWND owner = nullptr;
+
+    bool AddIcon(unsigned iconId, WINDOW_HANDLE window, const std::wstring& tip) override;
+    void RemoveIcon(unsigned iconId) override;
+    bool ReaddIcon(unsigned iconId) override;
+    HICON GetWindowIcon(unsigned iconId) const;
+    void SetTip(unsigned iconId, const wchar_t* tip);
+
+private:
+    std::unordered_map<unsigned, TRAY_ENTRY> entries;
+};
+
+class Win32HiddenView : public IHiddenView {
+public:
+    APP_STATE* state = nullptr;
+
+    void OnWindowHiding(const HIDDEN_WINDOW& item) override;
+    void OnWindowRestored(const HIDDEN_WINDOW& item) override;
+    void Refresh(const std::vector<HIDDEN_WINDOW>& items) override;
+};
+
 struct APP_STATE {
     HWND mainWindow = nullptr;
 
@@ -97,10 +168,15 @@ struct APP_STATE {
     HWND lblInstruction = nullptr;
 
     HMENU trayMenu = nullptr;
-    std::vector<HIDDEN_WINDOW> hiddenWindows;
-    UINT nextHiddenIconId = 1000;
     NOTIFYICONDATA mainIcon = { 0 };
 
+    // Core & Backend
+    CORE_STATE core;
+    Win32WindowSystem windowSystem;
+    Win32TrayHost trayHost;
+    DiskFileSystem fileSystem;
+    Win32HiddenView hiddenView;
+
     // GDI Objects
     HFONT hFontUi = nullptr;      // Standard text
     HFONT hFontBtn = nullptr;     // Button text (slightly bolder)
@@ -116,51 +192,99 @@ struct APP_STATE {
     bool isHoverMenu = false;
     bool isHoverCloseSett = false;
 
+    // Settings File (watched for external edits)
+    SettingsStore settings{ GetAppFilePath(SETTINGS_FILE) };
+
     // Hotkey Settings
     UINT hkModifiers = MOD_WIN | MOD_SHIFT;
     UINT hkKey = 0x5A; // Default Z
+
+    // Process Telemetry
+    std::unique_ptr<StatsSampler> statsSampler;
+    UINT statsIntervalMs = 2000;
+    int sortMode = SORT_BY_HIDDEN;
+
+    // Thumbnail Previews
+    ThumbnailCache thumbnails{ 8 * 1024 * 1024 };
+    UINT thumbBudgetKb = 8192;
+    HWND previewWindow = nullptr;
+    UINT previewIconId = 0;
+    DWORD lastTrayHover = 0;
+
+    // Auto-Hide ([AutoHide] rules)
+    FocusTracker focusTracker{ &windowSystem };
+    HWINEVENTHOOK hFocusHooks[2] = { nullptr, nullptr };
+
+    // Metrics ([Metrics] Path=<file or pipe> for a Prometheus text dump)
+    MetricsRegistry metrics;
+    std::unique_ptr<MetricsExporter> metricsExporter;
+    std::wstring metricsPath;
+    UINT metricsIntervalSec = 0;
+    Counter* autoHides = nullptr;
+    Counter* settingsReloads = nullptr;
+    Gauge* gdiObjects = nullptr;
+    Gauge* userObjects = nullptr;
+    Gauge* workingSet = nullptr;
+
+    // Event Trace Recording (/record <file>)
+    std::unique_ptr<TraceRecorder> recorder;
+    HWINEVENTHOOK hTraceHooks[2] = { nullptr, nullptr };
 };
 
 // --- Forward Declarations ---
-void SaveState(const APP_STATE* state);
 void LoadSettings(APP_STATE* state);
-void SaveSettings(const APP_STATE* state);
+void SaveSettings(APP_STATE* state);
+void ReloadSettings(APP_STATE* state);
+void UpdateAutoHide(APP_STATE* state);
+void UpdateMetricsExport(APP_STATE* state);
 void UpdateAppHotkey(APP_STATE* state);
-void RestoreWindow(APP_STATE* state, UINT iconId);
-void RestoreAll(APP_STATE* state);
-void MinimizeToTray(APP_STATE* state, HWND targetWindow = NULL);
 void InitTrayIcon(HWND hWnd, HINSTANCE hInstance, NOTIFYICONDATA* icon);
 void InitTrayMenu(HMENU* trayMenu);
-void LoadState(APP_STATE* state);
-void ReaddHiddenIcons(APP_STATE* state);
 void UpdateListView(APP_STATE* state);
+void UpdateListStats(APP_STATE* state);
+void UpdateStatsTargets(APP_STATE* state);
 HFONT CreateModernFont(int pointSize, int weight);
 void InvalidateButton(HWND hBtn);
 void ToggleSettingsView(APP_STATE* state, bool showSettings);
+bool CaptureWindowThumbnail(HWND hwnd, THUMBNAIL* thumb);
+void ShowPreview(APP_STATE* state, UINT iconId, POINT anchor);
+void HidePreview(APP_STATE* state);
 
 // --- Hotkey Control Logic ---
 
-std::wstring GetHotkeyString(UINT modifiers, UINT key) {
-    std::wstring text = L"";
-    if (modifiers & MOD_WIN)     text += L"Win + ";
-    if (modifiers & MOD_CONTROL) text += L"Ctrl + ";
-    if (modifiers & MOD_SHIFT)   text += L"Shift + ";
-    if (modifiers & MOD_ALT)     text += L"Alt + ";
-
-    if (key != 0) {
-        wchar_t keyName[128] = { 0 };
-        UINT scanCode = MapVirtualKey(key, MAPVK_VK_TO_VSC);
-        switch (key) {
-        case VK_LEFT: case VK_UP: case VK_RIGHT: case VK_DOWN:
-        case VK_PRIOR: case VK_NEXT: case VK_END: case VK_HOME:
-        case VK_INSERT: case VK_DELETE: case VK_DIVIDE: case VK_NUMLOCK:
-            scanCode |= 0x100;
-        }
-        if (GetKeyNameText(scanCode << 16, keyName, 128)) text += keyName;
-        else text += L"Unknown";
+static_assert(HK_MOD_ALT == MOD_ALT && HK_MOD_CONTROL == MOD_CONTROL && HK_MOD_SHIFT == MOD_SHIFT && HK_MOD_WIN == MOD_WIN,
+    "HotkeyNames.h modifier flags must match RegisterHotKey");
+
+class Win32KeyboardLayout : public IKeyboardLayout {
+public:
+    uintptr_t GetLayoutId() override { return (uintptr_t)GetKeyboardLayout(0); }
+
+    bool GetKeyName(unsigned vk, bool extended, wchar_t* buf, size_t bufLen) override {
+        UINT scanCode = MapVirtualKeyEx(vk, MAPVK_VK_TO_VSC, GetKeyboardLayout(0));
+        if (extended) scanCode |= 0x100;
+        return GetKeyNameText(scanCode << 16, buf, (int)bufLen) > 0;
     }
-    else text += L"None";
-    return text;
+};
+
+// Key names for the calling thread's layout. Checking the layout id on each
+// call is cheap and catches switches without listening for WM_INPUTLANGCHANGE.
+const KeyNameTable& CurrentKeyNames() {
+    static Win32KeyboardLayout layout;
+    static KeyNameTable table;
+    table.EnsureLayout(&layout);
+    return table;
+}
+
+size_t GetHotkeyString(UINT modifiers, UINT key, wchar_t* buf, size_t bufLen) {
+    return FormatHotkey(CurrentKeyNames(), modifiers, key, buf, bufLen);
+}
+
+void SetHotkeyText(HWND hWnd, const wchar_t* prefix, UINT modifiers, UINT key) {
+    wchar_t text[HOTKEY_TEXT_MAX + 16];
+    wcsncpy_s(text, prefix, _TRUNCATE);
+    size_t len = wcslen(text);
+    GetHotkeyString(modifiers, key, text + len, _countof(text) - len);
+    SetWindowText(hWnd, text);
 }
 
 LRESULT CALLBACK CustomHotkeySubclass(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData) {
@@ -173,8 +297,8 @@ LRESULT CALLBACK CustomHotkeySubclass(HWND hWnd, UINT uMsg, WPARAM wParam, LPARA
         if (GetKeyState(VK_CONTROL) & 0x8000) modifiers |= MOD_CONTROL;
         if (GetKeyState(VK_SHIFT) & 0x8000)   modifiers |= MOD_SHIFT;
         if (GetKeyState(VK_MENU) & 0x8000)    modifiers |= MOD_ALT;
-        UINT key = (wParam != VK_CONTROL && wParam != VK_SHIFT && wParam != VK_MENU && wParam != VK_LWIN && wParam != VK_RWIN) ? (UINT)wParam : 0;
-        SetWindowText(hWnd, GetHotkeyString(modifiers, key).c_str());
+        UINT key = IsModifierKey((UINT)wParam) ? 0 : (UINT)wParam;
+        SetHotkeyText(hWnd, L"", modifiers, key);
         CUSTOM_HOTKEY_DATA* data = (CUSTOM_HOTKEY_DATA*)GetWindowLongPtr(hWnd, GWLP_USERDATA);
         if (data) { data->modifiers = modifiers; data->vKey = key; }
         return 0;
@@ -207,28 +331,112 @@ void MakeCustomHotkeyControl(HWND hEdit, UINT defaultMod, UINT defaultKey) {
     data->vKey = defaultKey;
     SetWindowLongPtr(hEdit, GWLP_USERDATA, (LONG_PTR)data);
     SetWindowSubclass(hEdit, CustomHotkeySubclass, 0, 0);
-    SetWindowText(hEdit, GetHotkeyString(defaultMod, defaultKey).c_str());
+    SetHotkeyText(hEdit, L"", defaultMod, defaultKey);
 }
 
 // --- Logic Implementation ---
 
-void SaveState(const APP_STATE* state) {
-    if (state->hiddenWindows.empty()) { DeleteFile(SAVE_FILE.c_str()); return; }
-    std::wofstream file(SAVE_FILE, std::ios::trunc);
-    if (!file.is_open()) return;
-    for (const auto& item : state->hiddenWindows) {
-        if (item.window && IsWindow(item.window)) file << (uintptr_t)item.window << L"\n";
-    }
+void SaveSettings(APP_STATE* state) {
+    // Only our keys are set, on top of the newest file, so keys this version does not
+    // know and outside edits the watcher has not picked up yet survive the rewrite
+    state->settings.Save([state](Settings* next) {
+        StoreHotkeySetting(next, state->hkModifiers, state->hkKey);
+        next->SetInt(L"Settings", L"StatsInterval", (int)state->statsIntervalMs);
+        next->SetInt(L"Settings", L"SortMode", state->sortMode);
+        next->SetInt(L"Settings", L"ThumbnailBudgetKB", (int)state->thumbBudgetKb);
+    });
 }
 
-void SaveSettings(const APP_STATE* state) {
-    WritePrivateProfileString(L"Settings", L"Key", std::to_wstring(state->hkKey).c_str(), SETTINGS_FILE.c_str());
-    WritePrivateProfileString(L"Settings", L"Modifiers", std::to_wstring(state->hkModifiers).c_str(), SETTINGS_FILE.c_str());
+void ApplySettings(APP_STATE* state, const Settings& settings) {
+    unsigned modifiers = MOD_WIN | MOD_SHIFT, key = 0x5A;
+    LoadHotkeySetting(settings, CurrentKeyNames(), &modifiers, &key);
+    state->hkModifiers = modifiers;
+    state->hkKey = key;
+    state->statsIntervalMs = settings.GetInt(L"Settings", L"StatsInterval", 2000);
+    if ((int)state->statsIntervalMs < 250) state->statsIntervalMs = 250;
+    state->sortMode = settings.GetInt(L"Settings", L"SortMode", SORT_BY_HIDDEN);
+    if (state->sortMode < SORT_BY_HIDDEN || state->sortMode > SORT_BY_MEMORY) state->sortMode = SORT_BY_HIDDEN;
+    state->thumbBudgetKb = (UINT)std::clamp(settings.GetInt(L"Settings", L"ThumbnailBudgetKB", 8192), 0, THUMB_BUDGET_MAX_KB);
+    state->thumbnails.SetBudget((size_t)state->thumbBudgetKb * 1024);
+}
+
+// Older builds went through GetPrivateProfileString with the bare file name, which resolves
+// to the Windows directory; carry those settings over once. The bare name is deliberate here.
+bool ImportLegacySettings(Settings* out) {
+    wchar_t buffer[4096];
+    if (GetPrivateProfileSection(L"Settings", buffer, _countof(buffer), SETTINGS_FILE.c_str()) == 0) return false;
+    for (const wchar_t* line = buffer; *line; line += wcslen(line) + 1) {
+        const wchar_t* eq = wcschr(line, L'=');
+        if (eq) out->Set(L"Settings", std::wstring(line, eq - line), eq + 1);
+    }
+    return true;
 }
 
 void LoadSettings(APP_STATE* state) {
-    state->hkKey = GetPrivateProfileInt(L"Settings", L"Key", 0x5A, SETTINGS_FILE.c_str());
-    state->hkModifiers = GetPrivateProfileInt(L"Settings", L"Modifiers", MOD_WIN | MOD_SHIFT, SETTINGS_FILE.c_str());
+    if (!state->settings.Load()) {
+        Settings legacy;
+        if (ImportLegacySettings(&legacy)) state->settings.Save([&legacy](Settings* next) { *next = legacy; });
+    }
+    ApplySettings(state, *state->settings.Get());
+}
+
+// Picks up a snapshot the watcher swapped in after TrayCaddy.ini was edited outside the app.
+void ReloadSettings(APP_STATE* state) {
+    UINT oldModifiers = state->hkModifiers, oldKey = state->hkKey;
+    UINT oldInterval = state->statsIntervalMs;
+    int oldSort = state->sortMode;
+    ApplySettings(state, *state->settings.Get());
+
+    if (state->hkModifiers != oldModifiers || state->hkKey != oldKey) {
+        CUSTOM_HOTKEY_DATA* data = (CUSTOM_HOTKEY_DATA*)GetWindowLongPtr(state->hkControl, GWLP_USERDATA);
+        if (data) { data->modifiers = state->hkModifiers; data->vKey = state->hkKey; }
+        SetHotkeyText(state->hkControl, L"", state->hkModifiers, state->hkKey);
+        SetHotkeyText(state->lblCurrentHk, L"Current: ", state->hkModifiers, state->hkKey);
+        // While the hotkey box has focus the hotkey stays paused; WM_RESUME_HOTKEY registers the new one
+        if (GetFocus() != state->hkControl) UpdateAppHotkey(state);
+    }
+    if (state->statsIntervalMs != oldInterval && state->statsSampler) state->statsSampler->SetInterval(state->statsIntervalMs);
+    if (state->sortMode != oldSort) UpdateListView(state);
+    UpdateAutoHide(state);
+    UpdateMetricsExport(state);
+    state->settingsReloads->Add();
+}
+
+// --- Metrics ---
+
+void RegisterAppMetrics(APP_STATE* state) {
+    RegisterCoreMetrics(&state->metrics, &state->core.metrics);
+    state->autoHides = state->metrics.AddCounter("traycaddy_auto_hides_total", "Windows hidden by [AutoHide] rules.");
+    state->settingsReloads = state->metrics.AddCounter("traycaddy_settings_reloads_total", "Outside edits of TrayCaddy.ini picked up while running.");
+    state->gdiObjects = state->metrics.AddGauge("traycaddy_gdi_objects", "GDI objects held by TrayCaddy.");
+    state->userObjects = state->metrics.AddGauge("traycaddy_user_objects", "USER objects held by TrayCaddy.");
+    state->workingSet = state->metrics.AddGauge("traycaddy_working_set_bytes", "TrayCaddy's own working set.");
+    state->metricsExporter = std::make_unique<MetricsExporter>(&state->metrics);
+}
+
+// Starts, restarts or stops the dump to follow the [Metrics] section.
+void UpdateMetricsExport(APP_STATE* state) {
+    SETTINGS_SNAPSHOT settings = state->settings.Get();
+    std::wstring path = settings->GetString(L"Metrics", L"Path");
+    int intervalSec = settings->GetInt(L"Metrics", L"IntervalSec", 15);
+    if (intervalSec < 1) intervalSec = 1;
+    if (path == state->metricsPath && (UINT)intervalSec == state->metricsIntervalSec) return;
+    state->metricsPath = path;
+    state->metricsIntervalSec = intervalSec;
+    if (path.empty()) { state->metricsExporter->Stop(); return; }
+
+    // Sampled on the exporter thread; these calls are all safe off the UI thread
+    Gauge* gdiObjects = state->gdiObjects;
+    Gauge* userObjects = state->userObjects;
+    Gauge* workingSet = state->workingSet;
+    std::shared_ptr<IProcessStats> self(CreateProcessStats());
+    state->metricsExporter->Start(path, (unsigned)intervalSec * 1000, [=]() {
+        gdiObjects->Set(GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS));
+        userObjects->Set(GetGuiResources(GetCurrentProcess(), GR_USEROBJECTS));
+        std::vector<PROCESS_SAMPLE> samples;
+        self->QueryBatch({ (uint32_t)GetCurrentProcessId() }, samples);
+        if (!samples.empty() && samples[0].valid) workingSet->Set((int64_t)samples[0].workingSet);
+    });
 }
 
 void UpdateAppHotkey(APP_STATE* state) {
@@ -236,27 +444,99 @@ void UpdateAppHotkey(APP_STATE* state) {
     RegisterHotKey(state->mainWindow, HOTKEY_ID, state->hkModifiers | MOD_NOREPEAT, state->hkKey);
 }
 
-void ReaddHiddenIcons(APP_STATE* state) {
-    if (!state) return;
-    state->hiddenWindows.erase(std::remove_if(state->hiddenWindows.begin(), state->hiddenWindows.end(),
-        [](const HIDDEN_WINDOW& item) { return !item.window || !IsWindow(item.window); }), state->hiddenWindows.end());
-    for (auto& item : state->hiddenWindows) {
-        Shell_NotifyIcon(NIM_ADD, &item.icon);
-        item.icon.uVersion = NOTIFYICON_VERSION_4;
-        Shell_NotifyIcon(NIM_SETVERSION, &item.icon);
+// lParamSort points at the icon id -> row rank map built by UpdateListStats.
+int CALLBACK CompareListRank(LPARAM lParam1, LPARAM lParam2, LPARAM lParamSort) {
+    const auto* ranks = (const std::unordered_map<UINT, int>*)lParamSort;
+    auto a = ranks->find((UINT)lParam1), b = ranks->find((UINT)lParam2);
+    int rankA = a != ranks->end() ? a->second : INT_MAX;
+    int rankB = b != ranks->end() ? b->second : INT_MAX;
+    return rankA < rankB ? -1 : (rankA > rankB ? 1 : 0);
+}
+
+void UpdateStatsTargets(APP_STATE* state) {
+    if (!state->statsSampler) return;
+    std::vector<uint32_t> pids;
+    std::unordered_set<uint32_t> seen;
+    for (const auto& item : state->core.hiddenWindows) {
+        if (item.processId && seen.insert(item.processId).second) pids.push_back(item.processId);
     }
-    UpdateListView(state);
+    state->statsSampler->SetPids(pids);
+}
+
+void UpdateListStats(APP_STATE* state) {
+    if (!state->statsSampler) return;
+    std::unordered_map<uint32_t, PROCESS_USAGE> usage;
+    state->statsSampler->CopyUsage(&usage);
+
+    struct ROW_TEXT {
+        wchar_t cpu[16];
+        wchar_t memory[32];
+    };
+    size_t count = state->core.hiddenWindows.size();
+    std::vector<USAGE_SORT_KEY> keys;
+    std::vector<ROW_TEXT> texts(count);
+    std::unordered_map<UINT, size_t> textOf; // Icon id -> index into texts
+    keys.reserve(count);
+    textOf.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const HIDDEN_WINDOW& item = state->core.hiddenWindows[i];
+        USAGE_SORT_KEY key;
+        key.id = item.iconId;
+        ROW_TEXT& text = texts[i];
+        text.cpu[0] = text.memory[0] = L'\0';
+        auto found = usage.find(item.processId);
+        if (found != usage.end()) {
+            key.measured = true;
+            key.cpuPercent = found->second.cpuPercent;
+            key.workingSet = found->second.workingSet;
+            swprintf_s(text.cpu, L"%.1f%%", key.cpuPercent);
+            FormatBytes(key.workingSet, text.memory, _countof(text.memory));
+        }
+        keys.push_back(key);
+        textOf[item.iconId] = i;
+
+        // Tray tooltip: title on the first line, cost on the second
+        wchar_t tip[128];
+        if (text.cpu[0]) swprintf_s(tip, L"%.90s\nCPU %s  Mem %s", item.title.c_str(), text.cpu, text.memory);
+        else wcsncpy_s(tip, item.title.c_str(), _TRUNCATE);
+        state->trayHost.SetTip(item.iconId, tip);
+    }
+    if (!state->listView) return;
+
+    // One pass over the rows, matched by their icon id; searching the list for
+    // each item would be quadratic in the number of hidden windows
+    int rows = ListView_GetItemCount(state->listView);
+    for (int index = 0; index < rows; index++) {
+        LVITEM lvi = { 0 };
+        lvi.mask = LVIF_PARAM;
+        lvi.iItem = index;
+        if (!ListView_GetItem(state->listView, &lvi)) continue;
+        auto found = textOf.find((UINT)lvi.lParam);
+        if (found == textOf.end()) continue;
+        ListView_SetItemText(state->listView, index, COL_CPU, texts[found->second].cpu);
+        ListView_SetItemText(state->listView, index, COL_MEMORY, texts[found->second].memory);
+    }
+
+    // Sort the keys once; the comparator then only looks up ranks
+    static_assert(SORT_BY_HIDDEN == ORDER_AS_GIVEN && SORT_BY_CPU == ORDER_BY_CPU && SORT_BY_MEMORY == ORDER_BY_MEMORY,
+        "Sort modes must match USAGE_ORDER");
+    SortUsageKeys(keys, (USAGE_ORDER)state->sortMode);
+    std::unordered_map<UINT, int> ranks;
+    for (size_t i = 0; i < keys.size(); i++) ranks[keys[i].id] = (int)i;
+    ListView_SortItems(state->listView, CompareListRank, (LPARAM)&ranks);
 }
 
 void UpdateListView(APP_STATE* state) {
+    UpdateStatsTargets(state);
     if (!state->listView) return;
     ListView_DeleteAllItems(state->listView);
     ImageList_RemoveAll(state->hImageList);
 
     int index = 0;
-    for (auto& item : state->hiddenWindows) {
+    for (const auto& item : state->core.hiddenWindows) {
         int imgIdx = -1;
-        if (item.hWindowIcon) imgIdx = ImageList_AddIcon(state->hImageList, item.hWindowIcon);
+        HICON hWindowIcon = state->trayHost.GetWindowIcon(item.iconId);
+        if (hWindowIcon) imgIdx = ImageList_AddIcon(state->hImageList, hWindowIcon);
         else imgIdx = ImageList_AddIcon(state->hImageList, LoadIcon(NULL, IDI_APPLICATION));
 
         LVITEM lvItem = { 0 };
@@ -269,75 +549,10 @@ void UpdateListView(APP_STATE* state) {
         ListView_InsertItem(state->listView, &lvItem);
         index++;
     }
+    UpdateListStats(state);
     InvalidateRect(state->listView, NULL, TRUE);
 }
 
-void RestoreWindow(APP_STATE* state, UINT iconId) {
-    auto it = std::find_if(state->hiddenWindows.begin(), state->hiddenWindows.end(),
-        [&](const HIDDEN_WINDOW& item) { return item.iconId == iconId; });
-    if (it != state->hiddenWindows.end()) {
-        if (it->window && IsWindow(it->window)) {
-            ShowWindow(it->window, SW_RESTORE);
-            SetForegroundWindow(it->window);
-        }
-        Shell_NotifyIcon(NIM_DELETE, const_cast<PNOTIFYICONDATA>(&it->icon));
-        if (it->hWindowIcon) DestroyIcon(it->hWindowIcon);
-        state->hiddenWindows.erase(it);
-        SaveState(state);
-        UpdateListView(state);
-    }
-}
-
-void RestoreAll(APP_STATE* state) {
-    for (auto& item : state->hiddenWindows) {
-        if (item.window && IsWindow(item.window)) ShowWindow(item.window, SW_RESTORE);
-        Shell_NotifyIcon(NIM_DELETE, &item.icon);
-        if (item.hWindowIcon) DestroyIcon(item.hWindowIcon);
-    }
-    state->hiddenWindows.clear();
-    SaveState(state);
-    UpdateListView(state);
-}
-
-void MinimizeToTray(APP_STATE* state, HWND targetWindow) {
-    const wchar_t* restrictWins[] = { L"WorkerW", L"Shell_TrayWnd", L"Progman" };
-    HWND currWin = targetWindow ? targetWindow : GetForegroundWindow();
-    if (!currWin || !IsWindow(currWin) || currWin == state->mainWindow) return;
-
-    wchar_t className[256];
-    if (GetClassName(currWin, className, 256)) {
-        for (const auto& restricted : restrictWins) if (wcscmp(restricted, className) == 0) return;
-    }
-
-    HICON hIcon = (HICON)SendMessage(currWin, WM_GETICON, ICON_SMALL, 0);
-    if (!hIcon) hIcon = (HICON)GetClassLongPtr(currWin, GCLP_HICONSM);
-    if (!hIcon) hIcon = LoadIcon(NULL, IDI_APPLICATION);
-    HICON hStorageIcon = CopyIcon(hIcon);
-
-    NOTIFYICONDATA nid = { sizeof(NOTIFYICONDATA) };
-    nid.hWnd = state->mainWindow;
-    nid.hIcon = hIcon;
-    nid.uFlags = NIF_MESSAGE | NIF_ICON | NIF_TIP;
-    nid.uCallbackMessage = WM_ICON;
-    nid.uID = state->nextHiddenIconId++;
-    wchar_t titleBuf[128];
-    GetWindowText(currWin, titleBuf, 128);
-    wcscpy_s(nid.szTip, titleBuf);
-
-    if (Shell_NotifyIcon(NIM_ADD, &nid)) {
-        ShowWindow(currWin, SW_HIDE);
-        HIDDEN_WINDOW newItem;
-        newItem.icon = nid;
-        newItem.window = currWin;
-        newItem.iconId = nid.uID;
-        newItem.title = std::wstring(titleBuf);
-        newItem.hWindowIcon = hStorageIcon;
-        state->hiddenWindows.push_back(newItem);
-        if (!targetWindow) SaveState(state);
-        UpdateListView(state);
-    }
-}
-
 void InitTrayIcon(HWND hWnd, HINSTANCE hInstance, NOTIFYICONDATA* icon) {
     icon->cbSize = sizeof(NOTIFYICONDATA);
     icon->hWnd = hWnd;
@@ -359,20 +574,385 @@ void InitTrayMenu(HMENU* trayMenu) {
     InsertMenu(*trayMenu, 2, MF_BYPOSITION | MF_STRING, ID_MENU_EXIT, L"Exit");
 }
 
-void LoadState(APP_STATE* state) {
-    if (!std::filesystem::exists(SAVE_FILE)) return;
-    std::wifstream file(SAVE_FILE);
-    std::wstring line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        try {
-            uintptr_t val = std::stoull(line);
-            HWND hwnd = (HWND)val;
-            if (IsWindow(hwnd)) MinimizeToTray(state, hwnd);
+// --- Win32 Backend ---
+
+bool Win32WindowSystem::IsValidWindow(WINDOW_HANDLE window) { return IsWindow((HWND)window) != FALSE; }
+
+WINDOW_HANDLE Win32WindowSystem::GetForeground() { return (WINDOW_HANDLE)GetForegroundWindow(); }
+
+std::wstring GetWindowTitle(HWND hwnd) {
+    wchar_t titleBuf[256];
+    int len = GetWindowText(hwnd, titleBuf, 256);
+    return std::wstring(titleBuf, len > 0 ? len : 0);
+}
+
+std::wstring Win32WindowSystem::GetTitle(WINDOW_HANDLE window) { return GetWindowTitle((HWND)window); }
+
+std::wstring GetWindowClassName(HWND hwnd) {
+    wchar_t className[256];
+    int len = GetClassName(hwnd, className, 256);
+    return std::wstring(className, len > 0 ? len : 0);
+}
+
+std::wstring Win32WindowSystem::GetWindowClass(WINDOW_HANDLE window) { return GetWindowClassName((HWND)window); }
+
+uint32_t Win32WindowSystem::GetOwnerProcess(WINDOW_HANDLE window) {
+    DWORD processId = 0;
+    GetWindowThreadProcessId((HWND)window, &processId);
+    return processId;
+}
+
+void Win32WindowSystem::Hide(WINDOW_HANDLE window) { ShowWindow((HWND)window, SW_HIDE); }
+
+void Win32WindowSystem::Restore(WINDOW_HANDLE window, bool activate) {
+    ShowWindow((HWND)window, SW_RESTORE);
+    if (activate) SetForegroundWindow((HWND)window);
+}
+
+bool Win32TrayHost::AddIcon(unsigned iconId, WINDOW_HANDLE window, const std::wstring& tip) {
+    HWND hwnd = (HWND)window;
+    HICON hIcon = (HICON)SendMessage(hwnd, WM_GETICON, ICON_SMALL, 0);
+    if (!hIcon) hIcon = (HICON)GetClassLongPtr(hwnd, GCLP_HICONSM);
+    if (!hIcon) hIcon = LoadIcon(NULL, IDI_APPLICATION);
+
+    NOTIFYICONDATA nid = { sizeof(NOTIFYICONDATA) };
+    nid.hWnd = owner;
+    nid.hIcon = hIcon;
+    nid.uFlags = NIF_MESSAGE | NIF_ICON | NIF_TIP;
+    nid.uCallbackMessage = WM_ICON; // Version 0 callbacks: wParam = icon id, lParam = mouse message
+    nid.uID = iconId;
+    wcsncpy_s(nid.szTip, tip.c_str(), _TRUNCATE);
+    if (!Shell_NotifyIcon(NIM_ADD, &nid)) return false;
+
+    TRAY_ENTRY& entry = entries[iconId];
+    entry.icon = nid;
+    entry.hWindowIcon = CopyIcon(hIcon);
+    return true;
+}
+
+void Win32TrayHost::RemoveIcon(unsigned iconId) {
+    auto it = entries.find(iconId);
+    if (it == entries.end()) return;
+    Shell_NotifyIcon(NIM_DELETE, &it->second.icon);
+    if (it->second.hWindowIcon) DestroyIcon(it->second.hWindowIcon);
+    entries.erase(it);
+}
+
+bool Win32TrayHost::ReaddIcon(unsigned iconId) {
+    auto it = entries.find(iconId);
+    if (it == entries.end()) return false;
+    // Same legacy version as AddIcon, or WM_ICON would start receiving coordinates in wParam
+    return Shell_NotifyIcon(NIM_ADD, &it->second.icon) != FALSE;
+}
+
+HICON Win32TrayHost::GetWindowIcon(unsigned iconId) const {
+    auto it = entries.find(iconId);
+    return it == entries.end() ? nullptr : it->second.hWindowIcon;
+}
+
+void Win32TrayHost::SetTip(unsigned iconId, const wchar_t* tip) {
+    auto it = entries.find(iconId);
+    if (it == entries.end() || wcscmp(tip, it->second.icon.szTip) == 0) return;
+    wcsncpy_s(it->second.icon.szTip, tip, _TRUNCATE);
+    Shell_NotifyIcon(NIM_MODIFY, &it->second.icon);
+}
+
+void Win32HiddenView::OnWindowHiding(const HIDDEN_WINDOW& item) {
+    // Snapshot while the window is still on screen
+    THUMBNAIL thumb;
+    if (CaptureWindowThumbnail((HWND)item.window, &thumb)) state->thumbnails.Put(item.iconId, std::move(thumb));
+}
+
+void Win32HiddenView::OnWindowRestored(const HIDDEN_WINDOW& item) {
+    if (state->previewIconId == item.iconId) HidePreview(state);
+    state->thumbnails.Remove(item.iconId);
+}
+
+void Win32HiddenView::Refresh(const std::vector<HIDDEN_WINDOW>& items) { UpdateListView(state); }
+
+// --- Thumbnail Previews ---
+
+bool CaptureWindowThumbnail(HWND hwnd, THUMBNAIL* thumb) {
+    // Hidden or minimized windows have nothing meaningful to render
+    if (!IsWindowVisible(hwnd) || IsIconic(hwnd)) return false;
+    RECT rc;
+    if (!GetWindowRect(hwnd, &rc)) return false;
+    int w = rc.right - rc.left;
+    int h = rc.bottom - rc.top;
+    if (w <= 0 || h <= 0) return false;
+
+    BITMAPINFO bmi = { 0 };
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = w;
+    bmi.bmiHeader.biHeight = -h; // Top-down
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    HDC hdcScreen = GetDC(NULL);
+    HDC hdcMem = CreateCompatibleDC(hdcScreen);
+    void* bits = nullptr;
+    HBITMAP hBmp = CreateDIBSection(hdcScreen, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    bool captured = false;
+    if (hBmp && bits) {
+        HGDIOBJ hOld = SelectObject(hdcMem, hBmp);
+        if (PrintWindow(hwnd, hdcMem, PW_RENDERFULLCONTENT)) {
+            GdiFlush();
+            captured = MakeThumbnail((const uint8_t*)bits, w, h, (size_t)w * 4, THUMB_MAX_W, THUMB_MAX_H, thumb);
         }
-        catch (...) {}
+        SelectObject(hdcMem, hOld);
     }
-    UpdateListView(state);
+    if (hBmp) DeleteObject(hBmp);
+    DeleteDC(hdcMem);
+    ReleaseDC(NULL, hdcScreen);
+    return captured;
+}
+
+void ShowPreview(APP_STATE* state, UINT iconId, POINT anchor) {
+    if (!state->previewWindow) return;
+    if (state->previewIconId == iconId && IsWindowVisible(state->previewWindow)) return;
+    const THUMBNAIL* thumb = state->thumbnails.Get(iconId);
+    if (!thumb) { HidePreview(state); return; }
+    state->previewIconId = iconId;
+
+    int w = thumb->width + PREVIEW_BORDER * 2;
+    int h = thumb->height + PREVIEW_BORDER * 2;
+    MONITORINFO mi = { sizeof(MONITORINFO) };
+    GetMonitorInfo(MonitorFromPoint(anchor, MONITOR_DEFAULTTONEAREST), &mi);
+    RECT work = mi.rcWork;
+
+    // Prefer the left of the cursor; both the main window and the tray live at the bottom right
+    int x = anchor.x - w - 16;
+    if (x < work.left) x = anchor.x + 16;
+    if (x + w > work.right) x = work.right - w;
+    int y = anchor.y - h / 2;
+    if (y + h > work.bottom) y = work.bottom - h;
+    if (y < work.top) y = work.top;
+
+    SetWindowPos(state->previewWindow, HWND_TOPMOST, x, y, w, h, SWP_NOACTIVATE | SWP_SHOWWINDOW);
+    InvalidateRect(state->previewWindow, NULL, FALSE);
+}
+
+void HidePreview(APP_STATE* state) {
+    state->previewIconId = 0;
+    if (state->mainWindow) KillTimer(state->mainWindow, ID_TIMER_PREVIEW);
+    if (state->previewWindow) ShowWindow(state->previewWindow, SW_HIDE);
+}
+
+LRESULT CALLBACK PreviewProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    APP_STATE* state = (APP_STATE*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+    if (uMsg == WM_NCCREATE) {
+        CREATESTRUCT* pCreate = (CREATESTRUCT*)lParam;
+        state = (APP_STATE*)pCreate->lpCreateParams;
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG_PTR)state);
+    }
+
+    switch (uMsg) {
+    case WM_PAINT: {
+        PAINTSTRUCT ps;
+        HDC hdc = BeginPaint(hwnd, &ps);
+        RECT rc; GetClientRect(hwnd, &rc);
+        HBRUSH hBorder = CreateSolidBrush(CLR_BORDER);
+        FillRect(hdc, &rc, hBorder);
+        DeleteObject(hBorder);
+
+        const THUMBNAIL* thumb = state ? state->thumbnails.Get(state->previewIconId) : nullptr;
+        if (thumb) {
+            struct { BITMAPINFOHEADER header; DWORD masks[3]; } bmi = { 0 };
+            bmi.header.biSize = sizeof(BITMAPINFOHEADER);
+            bmi.header.biWidth = thumb->stride;
+            bmi.header.biHeight = -thumb->height;
+            bmi.header.biPlanes = 1;
+            bmi.header.biBitCount = 16;
+            bmi.header.biCompression = BI_BITFIELDS;
+            bmi.masks[0] = 0xF800; bmi.masks[1] = 0x07E0; bmi.masks[2] = 0x001F;
+            SetDIBitsToDevice(hdc, PREVIEW_BORDER, PREVIEW_BORDER, thumb->width, thumb->height, 0, 0, 0, thumb->height,
+                thumb->pixels.data(), (BITMAPINFO*)&bmi, DIB_RGB_COLORS);
+        }
+        EndPaint(hwnd, &ps);
+        return 0;
+    }
+    case WM_MOUSEACTIVATE: return MA_NOACTIVATE;
+    case WM_NCHITTEST: return HTTRANSPARENT;
+    }
+    return DefWindowProc(hwnd, uMsg, wParam, lParam);
+}
+
+LRESULT CALLBACK ListPreviewSubclass(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam, UINT_PTR uIdSubclass, DWORD_PTR dwRefData) {
+    APP_STATE* state = (APP_STATE*)dwRefData;
+    switch (uMsg) {
+    case WM_MOUSEMOVE: {
+        LVHITTESTINFO hit = { 0 };
+        hit.pt = { GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+        int index = ListView_HitTest(hWnd, &hit);
+        if (index == -1) HidePreview(state);
+        else {
+            LVITEM item = { 0 }; item.iItem = index; item.mask = LVIF_PARAM;
+            ListView_GetItem(hWnd, &item);
+            POINT pt = hit.pt;
+            ClientToScreen(hWnd, &pt);
+            ShowPreview(state, (UINT)item.lParam, pt);
+        }
+        TRACKMOUSEEVENT tme = { sizeof(TRACKMOUSEEVENT), TME_LEAVE, hWnd, 0 };
+        TrackMouseEvent(&tme);
+        break;
+    }
+    case WM_MOUSELEAVE: HidePreview(state); break;
+    case WM_NCDESTROY: RemoveWindowSubclass(hWnd, ListPreviewSubclass, uIdSubclass); break;
+    }
+    return DefSubclassProc(hWnd, uMsg, wParam, lParam);
+}
+
+// --- Event Trace Recording ---
+
+// WinEvent callbacks carry no user data
+static TraceRecorder* s_traceRecorder = nullptr;
+static std::unordered_set<HWND> s_tracedWindows; // Top-level windows already in the trace
+
+void CALLBACK TraceWinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD idEventThread, DWORD dwmsEventTime) {
+    if (!s_traceRecorder || !hwnd || idObject != OBJID_WINDOW || idChild != CHILDID_SELF) return;
+    if (event == EVENT_OBJECT_DESTROY) {
+        // The window is already gone, so only destroys of windows we have seen are kept
+        if (s_tracedWindows.erase(hwnd)) s_traceRecorder->Record(TRACE_WINDOW_DESTROYED, (uint64_t)hwnd);
+        return;
+    }
+    if (GetAncestor(hwnd, GA_ROOT) != hwnd) return;
+
+    DWORD processId = 0;
+    GetWindowThreadProcessId(hwnd, &processId);
+    if (event == EVENT_OBJECT_CREATE) {
+        s_tracedWindows.insert(hwnd);
+        s_traceRecorder->Record(TRACE_WINDOW_CREATED, (uint64_t)hwnd, 0, processId, GetWindowTitle(hwnd), GetWindowClassName(hwnd));
+    }
+    else if (event == EVENT_OBJECT_NAMECHANGE && s_tracedWindows.count(hwnd)) {
+        s_traceRecorder->Record(TRACE_WINDOW_TITLE, (uint64_t)hwnd, 0, processId, GetWindowTitle(hwnd));
+    }
+}
+
+// Hotkey and hide events are recorded after the core handled them, with the
+// icon id the window got (0 if it was not hidden) so replays can follow it.
+void RecordTraceHide(TRACE_EVENT_TYPE type, HWND window, unsigned iconId) {
+    DWORD processId = 0;
+    GetWindowThreadProcessId(window, &processId);
+    s_tracedWindows.insert(window);
+    s_traceRecorder->Record(type, (uint64_t)window, iconId, processId, GetWindowTitle(window), GetWindowClassName(window));
+}
+
+void RecordTraceMessage(UINT uMsg, WPARAM wParam, LPARAM lParam, UINT taskbarCreatedMsg) {
+    switch (uMsg) {
+    case WM_ICON: s_traceRecorder->Record(TRACE_TRAY_ICON, 0, (uint32_t)wParam, (uint32_t)lParam); break;
+    case WM_COMMAND: s_traceRecorder->Record(TRACE_COMMAND, 0, LOWORD(wParam)); break;
+    default:
+        if (taskbarCreatedMsg != 0 && uMsg == taskbarCreatedMsg) s_traceRecorder->Record(TRACE_TASKBAR_CREATED);
+    }
+}
+
+void StartTraceRecording(APP_STATE* state, const std::wstring& path) {
+    state->recorder = std::make_unique<TraceRecorder>();
+    if (!state->recorder->Open(path)) { state->recorder.reset(); return; }
+    s_traceRecorder = state->recorder.get();
+    SetTimer(state->mainWindow, ID_TIMER_TRACE, TRACE_FLUSH_MS, NULL); // Writes out window churn that no action followed
+    state->hTraceHooks[0] = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_DESTROY, NULL, TraceWinEventProc, 0, 0,
+        WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    state->hTraceHooks[1] = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, NULL, TraceWinEventProc, 0, 0,
+        WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+}
+
+void StopTraceRecording(APP_STATE* state) {
+    for (auto& hook : state->hTraceHooks) {
+        if (hook) UnhookWinEvent(hook);
+        hook = nullptr;
+    }
+    if (state->recorder) KillTimer(state->mainWindow, ID_TIMER_TRACE);
+    s_traceRecorder = nullptr;
+    s_tracedWindows.clear();
+    state->recorder.reset();
+}
+
+// --- Auto-Hide ---
+
+static APP_STATE* s_autoHideState = nullptr; // For FocusWinEventProc
+
+uint64_t AutoHideClock() { return GetTickCount64() / 1000; }
+
+// Same kind of window the hotkey would hide: a visible, titled, unowned top-level window.
+bool IsAutoHideCandidate(const APP_STATE* state, HWND hwnd) {
+    if (!hwnd || hwnd == state->mainWindow || !IsWindowVisible(hwnd)) return false;
+    if (GetAncestor(hwnd, GA_ROOT) != hwnd || GetWindow(hwnd, GW_OWNER)) return false;
+    if (GetWindowLongPtr(hwnd, GWL_EXSTYLE) & WS_EX_TOOLWINDOW) return false;
+    return GetWindowTextLength(hwnd) > 0;
+}
+
+// One timer for all tracked windows, re-armed for the earliest one due.
+void ScheduleAutoHideTimer(APP_STATE* state) {
+    uint64_t due = state->focusTracker.NextDueTime();
+    if (due == WHEEL_NO_TIMER) { KillTimer(state->mainWindow, ID_TIMER_AUTOHIDE); return; }
+    uint64_t now = AutoHideClock();
+    uint64_t delaySec = due > now ? due - now : 0;
+    if (delaySec > 3600) delaySec = 3600;
+    SetTimer(state->mainWindow, ID_TIMER_AUTOHIDE, delaySec ? (UINT)delaySec * 1000 : USER_TIMER_MINIMUM, NULL);
+}
+
+void CALLBACK FocusWinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD idEventThread, DWORD dwmsEventTime) {
+    APP_STATE* state = s_autoHideState;
+    if (!state || idObject != OBJID_WINDOW || idChild != CHILDID_SELF) return;
+    if (event == EVENT_OBJECT_DESTROY) {
+        state->focusTracker.Forget((WINDOW_HANDLE)hwnd);
+        return;
+    }
+    // Focus on the desktop, taskbar or TrayCaddy itself still starts the previous window's idle clock
+    state->focusTracker.OnForeground(IsAutoHideCandidate(state, hwnd) ? (WINDOW_HANDLE)hwnd : 0, AutoHideClock());
+    ScheduleAutoHideTimer(state);
+}
+
+BOOL CALLBACK SeedAutoHideWindow(HWND hwnd, LPARAM lParam) {
+    APP_STATE* state = (APP_STATE*)lParam;
+    if (IsAutoHideCandidate(state, hwnd)) state->focusTracker.Track((WINDOW_HANDLE)hwnd, AutoHideClock());
+    return TRUE;
+}
+
+void RunAutoHide(APP_STATE* state) {
+    std::vector<WINDOW_HANDLE> due;
+    state->focusTracker.Collect(AutoHideClock(), &due);
+    for (WINDOW_HANDLE window : due) {
+        // Skip windows hidden by hand or otherwise changed since they were armed
+        if (!IsAutoHideCandidate(state, (HWND)window) || (HWND)window == GetForegroundWindow()) continue;
+        if (!MinimizeToTray(&state->core, window)) continue;
+        state->autoHides->Add();
+        if (s_traceRecorder) RecordTraceHide(TRACE_HIDE, (HWND)window, state->core.hiddenWindows.back().iconId);
+    }
+    ScheduleAutoHideTimer(state);
+}
+
+void StopAutoHide(APP_STATE* state) {
+    for (auto& hook : state->hFocusHooks) {
+        if (hook) UnhookWinEvent(hook);
+        hook = nullptr;
+    }
+    s_autoHideState = nullptr;
+    state->focusTracker.Clear();
+    KillTimer(state->mainWindow, ID_TIMER_AUTOHIDE);
+}
+
+// Applies the [AutoHide] rules of the current settings; the hooks only exist while a rule can hide something.
+void UpdateAutoHide(APP_STATE* state) {
+    uint64_t now = AutoHideClock();
+    state->focusTracker.SetRules(LoadAutoHideRules(*state->settings.Get()), now);
+    bool running = state->hFocusHooks[0] != nullptr;
+
+    if (state->focusTracker.IsEnabled() && !running) {
+        s_autoHideState = state;
+        state->hFocusHooks[0] = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, NULL, FocusWinEventProc, 0, 0,
+            WINEVENT_OUTOFCONTEXT);
+        state->hFocusHooks[1] = SetWinEventHook(EVENT_OBJECT_DESTROY, EVENT_OBJECT_DESTROY, NULL, FocusWinEventProc, 0, 0,
+            WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+        // Windows already open start idling now
+        EnumWindows(SeedAutoHideWindow, (LPARAM)state);
+        HWND fg = GetForegroundWindow();
+        state->focusTracker.OnForeground(IsAutoHideCandidate(state, fg) ? (WINDOW_HANDLE)fg : 0, now);
+    }
+    else if (!state->focusTracker.IsEnabled() && running) StopAutoHide(state);
+    ScheduleAutoHideTimer(state);
 }
 
 // --- UI Logic & Rendering ---
@@ -467,7 +1047,7 @@ void DrawModernButton(LPDRAWITEMSTRUCT pDIS, const APP_STATE* state) {
 }
 
 LRESULT HandleListCustomDraw(APP_STATE* state, LPARAM lParam) {
-    if (state->hiddenWindows.empty()) {
+    if (state->core.hiddenWindows.empty()) {
         HDC hdc = GetDC(state->listView);
         RECT rc; GetClientRect(state->listView, &rc);
         SetBkColor(hdc, CLR_LIST_BG);
@@ -491,9 +1071,10 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 
     static UINT s_taskbarCreatedMsg = 0;
     if (s_taskbarCreatedMsg == 0) s_taskbarCreatedMsg = RegisterWindowMessage(L"TaskbarCreated");
+    if (s_traceRecorder) RecordTraceMessage(uMsg, wParam, lParam, s_taskbarCreatedMsg);
     if (s_taskbarCreatedMsg != 0 && uMsg == s_taskbarCreatedMsg && state) {
         InitTrayIcon(hwnd, GetModuleHandle(NULL), &state->mainIcon);
-        ReaddHiddenIcons(state);
+        ReaddHiddenIcons(&state->core);
         return 0;
     }
 
@@ -535,13 +1116,25 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         int iconSize = GetSystemMetrics(SM_CXSMICON);
         state->hImageList = ImageList_Create(iconSize, iconSize, ILC_COLOR32 | ILC_MASK, 1, 1);
         ListView_SetImageList(state->listView, state->hImageList, LVSIL_SMALL);
+        SetWindowSubclass(state->listView, ListPreviewSubclass, 0, (DWORD_PTR)state);
 
+        const int cpuColW = 52;
+        const int memColW = 72;
         LVCOLUMN lvc = { 0 };
         lvc.mask = LVCF_FMT | LVCF_WIDTH | LVCF_TEXT;
         lvc.fmt = LVCFMT_LEFT;
-        lvc.cx = clientW - (margin * 2) - 20;
+        lvc.cx = clientW - (margin * 2) - 20 - cpuColW - memColW;
         lvc.pszText = (LPWSTR)L"Window Title";
-        ListView_InsertColumn(state->listView, 0, &lvc);
+        ListView_InsertColumn(state->listView, COL_TITLE, &lvc);
+
+        lvc.fmt = LVCFMT_RIGHT;
+        lvc.cx = cpuColW;
+        lvc.pszText = (LPWSTR)L"CPU";
+        ListView_InsertColumn(state->listView, COL_CPU, &lvc);
+
+        lvc.cx = memColW;
+        lvc.pszText = (LPWSTR)L"Memory";
+        ListView_InsertColumn(state->listView, COL_MEMORY, &lvc);
 
         ListView_SetExtendedListViewStyle(state->listView, LVS_EX_FULLROWSELECT | LVS_EX_DOUBLEBUFFER);
         ListView_SetBkColor(state->listView, CLR_LIST_BG);
@@ -672,15 +1265,35 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             state->hkKey = data->vKey;
             state->hkModifiers = data->modifiers;
             SaveSettings(state);
-            std::wstring newLabel = L"Saved: " + GetHotkeyString(state->hkModifiers, state->hkKey);
-            SetWindowText(state->lblCurrentHk, newLabel.c_str());
+            SetHotkeyText(state->lblCurrentHk, L"Saved: ", state->hkModifiers, state->hkKey);
         }
         break;
     }
     case WM_PAUSE_HOTKEY: if (state) UnregisterHotKey(state->mainWindow, HOTKEY_ID); break;
     case WM_RESUME_HOTKEY: if (state) UpdateAppHotkey(state); break;
+    case WM_STATS_UPDATED: if (state) UpdateListStats(state); break;
+    case WM_SETTINGS_CHANGED: if (state) ReloadSettings(state); break;
 
-    case WM_ICON: if (state && lParam == WM_LBUTTONDBLCLK) RestoreWindow(state, (UINT)wParam); break;
+    case WM_ICON:
+        if (!state) break;
+        if (lParam == WM_LBUTTONDBLCLK) RestoreWindow(&state->core, (UINT)wParam);
+        else if (lParam == WM_MOUSEMOVE) {
+            // The tray sends no leave notification, so the preview is hidden once moves stop arriving
+            POINT pt; GetCursorPos(&pt);
+            ShowPreview(state, (UINT)wParam, pt);
+            state->lastTrayHover = GetTickCount();
+            SetTimer(hwnd, ID_TIMER_PREVIEW, 200, NULL);
+        }
+        break;
+    case WM_TIMER:
+        if (state && wParam == ID_TIMER_PREVIEW && GetTickCount() - state->lastTrayHover > 400) HidePreview(state);
+        if (state && wParam == ID_TIMER_AUTOHIDE) RunAutoHide(state);
+        if (state && wParam == ID_TIMER_TRACE && state->recorder) state->recorder->Flush();
+        break;
+    case WM_ENDSESSION:
+        // The process may be ended any time after this returns
+        if (state && wParam) StopTraceRecording(state);
+        return 0;
     case WM_OURICON:
         if (!state) break;
         if (LOWORD(lParam) == WM_LBUTTONDBLCLK) { ShowWindow(hwnd, SW_SHOW); SetForegroundWindow(hwnd); }
@@ -708,6 +1321,10 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             HMENU hPop = CreatePopupMenu();
             AppendMenu(hPop, MF_STRING, ID_MENU_OPEN_PREFS, L"Preferences");
             AppendMenu(hPop, MF_SEPARATOR, 0, NULL);
+            AppendMenu(hPop, MF_STRING | (state->sortMode == SORT_BY_HIDDEN ? MF_CHECKED : 0), ID_MENU_SORT_HIDDEN, L"Sort by hide order");
+            AppendMenu(hPop, MF_STRING | (state->sortMode == SORT_BY_CPU ? MF_CHECKED : 0), ID_MENU_SORT_CPU, L"Sort by CPU");
+            AppendMenu(hPop, MF_STRING | (state->sortMode == SORT_BY_MEMORY ? MF_CHECKED : 0), ID_MENU_SORT_MEMORY, L"Sort by memory");
+            AppendMenu(hPop, MF_SEPARATOR, 0, NULL);
             AppendMenu(hPop, MF_STRING, ID_MENU_EXIT, L"Exit");
 
             RECT rc; GetWindowRect(state->btnMenu, &rc);
@@ -716,10 +1333,14 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                 rc.left, rc.bottom, 0, hwnd, NULL);
 
             if (selection == ID_MENU_OPEN_PREFS) {
-                std::wstring cur = L"Current: " + GetHotkeyString(state->hkModifiers, state->hkKey);
-                SetWindowText(state->lblCurrentHk, cur.c_str());
+                SetHotkeyText(state->lblCurrentHk, L"Current: ", state->hkModifiers, state->hkKey);
                 ToggleSettingsView(state, true);
             }
+            else if (selection >= ID_MENU_SORT_HIDDEN && selection <= ID_MENU_SORT_MEMORY) {
+                state->sortMode = selection - ID_MENU_SORT_HIDDEN;
+                SaveSettings(state);
+                UpdateListStats(state);
+            }
             else if (selection == ID_MENU_EXIT) {
                 PostQuitMessage(0);
             }
@@ -730,7 +1351,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             ToggleSettingsView(state, false);
         }
 
-        if (id == ID_BTN_RESTORE_ALL || id == ID_MENU_RESTORE_ALL) RestoreAll(state);
+        if (id == ID_BTN_RESTORE_ALL || id == ID_MENU_RESTORE_ALL) RestoreAll(&state->core);
         break;
     }
 
@@ -743,14 +1364,23 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             if (lpnmitem->iItem != -1) {
                 LVITEM item = { 0 }; item.iItem = lpnmitem->iItem; item.mask = LVIF_PARAM;
                 ListView_GetItem(state->listView, &item);
-                RestoreWindow(state, (UINT)item.lParam);
+                UINT iconId = (UINT)item.lParam;
+                bool wasHidden = FindHiddenWindow(&state->core, iconId) != nullptr;
+                RestoreWindow(&state->core, iconId);
+                if (s_traceRecorder && wasHidden) s_traceRecorder->Record(TRACE_RESTORE, 0, iconId);
             }
         }
         break;
     }
     case WM_CLOSE: ShowWindow(hwnd, SW_HIDE); return 0;
     case WM_DESTROY: PostQuitMessage(0); return 0;
-    case WM_HOTKEY: if (state && wParam == HOTKEY_ID) MinimizeToTray(state, NULL); break;
+    case WM_HOTKEY:
+        if (state && wParam == HOTKEY_ID) {
+            HWND fg = GetForegroundWindow();
+            bool hidden = MinimizeToTray(&state->core);
+            if (s_traceRecorder) RecordTraceHide(TRACE_HOTKEY, fg, hidden ? state->core.hiddenWindows.back().iconId : 0);
+        }
+        break;
     default: return DefWindowProc(hwnd, uMsg, wParam, lParam);
     }
     return 0;
@@ -762,6 +1392,16 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
     if (hMutex == NULL || GetLastError() == ERROR_ALREADY_EXISTS) return 1;
 
     APP_STATE* appState = new APP_STATE();
+    appState->hiddenView.state = appState;
+    appState->core.windows = &appState->windowSystem;
+    appState->core.tray = &appState->trayHost;
+    appState->core.files = &appState->fileSystem;
+    appState->core.view = &appState->hiddenView;
+    appState->core.saveFile = GetAppFilePath(SAVE_FILE);
+    // Older builds kept the list in the working directory; fails harmlessly if there is none
+    // or one already sits next to the exe
+    MoveFileEx(SAVE_FILE.c_str(), appState->core.saveFile.c_str(), MOVEFILE_COPY_ALLOWED);
+    RegisterAppMetrics(appState);
     LoadSettings(appState);
     appState->hBrushBg = CreateSolidBrush(CLR_BG_DARK);
 
@@ -794,19 +1434,53 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
         x, y, w, h, NULL, NULL, hInstance, appState);
 
     if (!appState->mainWindow) return 1;
+    appState->core.ownWindow = (WINDOW_HANDLE)appState->mainWindow;
+    appState->trayHost.owner = appState->mainWindow;
+
+    WNDCLASS wcPreview = { 0 };
+    wcPreview.lpfnWndProc = PreviewProc;
+    wcPreview.hInstance = hInstance;
+    wcPreview.lpszClassName = L"TrayCaddyPreview";
+    wcPreview.hCursor = LoadCursor(NULL, IDC_ARROW);
+    RegisterClass(&wcPreview);
+    appState->previewWindow = CreateWindowEx(WS_EX_TOOLWINDOW | WS_EX_TOPMOST | WS_EX_NOACTIVATE, L"TrayCaddyPreview", L"",
+        WS_POPUP, 0, 0, 0, 0, appState->mainWindow, NULL, hInstance, appState);
 
     MakeCustomHotkeyControl(appState->hkControl, appState->hkModifiers, appState->hkKey);
     SendMessage(appState->mainWindow, WM_SETFONT, (WPARAM)appState->hFontUi, TRUE);
     InitTrayIcon(appState->mainWindow, hInstance, &appState->mainIcon);
     InitTrayMenu(&appState->trayMenu);
     UpdateAppHotkey(appState);
-    LoadState(appState);
+
+    appState->statsSampler = std::make_unique<StatsSampler>(CreateProcessStats(), appState->statsIntervalMs);
+    HWND hMain = appState->mainWindow;
+    appState->statsSampler->Start([hMain]() { PostMessage(hMain, WM_STATS_UPDATED, 0, 0); });
+    appState->settings.StartWatching([hMain]() { PostMessage(hMain, WM_SETTINGS_CHANGED, 0, 0); });
+
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    for (int i = 1; argv && i + 1 < argc; i++) {
+        if (_wcsicmp(argv[i], L"/record") == 0) { StartTraceRecording(appState, argv[i + 1]); break; }
+    }
+    if (argv) LocalFree(argv);
+
+    LoadState(&appState->core);
+    if (s_traceRecorder) {
+        for (const auto& item : appState->core.hiddenWindows) RecordTraceHide(TRACE_HIDE, (HWND)item.window, item.iconId);
+    }
+    UpdateAutoHide(appState);
+    UpdateMetricsExport(appState);
     ShowWindow(appState->mainWindow, SW_SHOW);
 
     MSG msg = { 0 };
     while (GetMessage(&msg, NULL, 0, 0)) { TranslateMessage(&msg); DispatchMessage(&msg); }
 
-    RestoreAll(appState);
+    StopTraceRecording(appState);
+    appState->statsSampler->Stop();
+    appState->settings.StopWatching();
+    StopAutoHide(appState);
+    appState->metricsExporter->Stop();
+    RestoreAll(&appState->core);
     Shell_NotifyIcon(NIM_DELETE, &appState->mainIcon);
     UnregisterHotKey(appState->mainWindow, HOTKEY_ID);
     if (appState->trayMenu) DestroyMenu(appState->trayMenu);
@@ -4,6 +4,24 @@
 //
 #define IDI_ICON1                       101
 
+// Control IDs
+#define ID_BTN_RESTORE_ALL    0x200
+#define ID_LIST_WINDOWS       0x202
+#define ID_HK_CONTROL         0x203
+#define ID_LBL_CURRENT_HK     0x204
+#define ID_BTN_MENU           0x205 
+#define ID_BTN_CLOSE_SETTINGS 0x206 
+#define ID_LBL_INSTR          0x208
+#define ID_LBL_SETTINGS_TITLE 0x209 
+
+// Command IDs (also read by the trace replayer)
+#define ID_MENU_RESTORE_ALL   0x98
+#define ID_MENU_EXIT          0x99
+#define ID_MENU_OPEN_PREFS    0x100 
+#define ID_MENU_SORT_HIDDEN   0x101
+#define ID_MENU_SORT_CPU      0x102
+#define ID_MENU_SORT_MEMORY   0x103
+
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
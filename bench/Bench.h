@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// --- Benchmarks ---
+// Minimal harness shared by the bench_* programs. Each case is timed once
+// with steady_clock and printed as a table row; with --json <file> the whole
+// run is also written as one document for regression tracking:
+//
+//   {"suite": "core", "results": [
+//     {"name": "hide", "size": 1000, "ops": 256, "ns_per_op": 812.5, "total_ms": 0.208},
+//     ...]}
+//
+// --quick caps the problem sizes so ctest can run every benchmark as a smoke
+// test; the numbers from such a run are not meant to be compared.
+
+struct BENCH_RESULT {
+    std::string name;
+    size_t size = 0; // Problem size, e.g. windows tracked
+    size_t ops = 0;  // Operations timed
+    double totalNs = 0;
+};
+
+// Keeps the optimizer from dropping work whose result is otherwise unused.
+inline void BenchConsume(uint64_t value) {
+    static volatile uint64_t sink;
+    sink = sink + value;
+}
+
+class BenchReport {
+public:
+    BenchReport(const char* suite, int argc, char** argv) : suite(suite) {
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--quick") == 0) quick = true;
+            else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        }
+        printf("%-32s %10s %10s %14s %12s\n", suite, "size", "ops", "ns/op", "total ms");
+    }
+
+    bool IsQuick() const { return quick; }
+
+    // sizes, without the ones above quickLimit under --quick.
+    std::vector<size_t> Sizes(std::initializer_list<size_t> sizes, size_t quickLimit) const {
+        std::vector<size_t> out;
+        for (size_t size : sizes) if (!quick || size <= quickLimit) out.push_back(size);
+        return out;
+    }
+
+    void Add(const std::string& name, size_t size, size_t ops, std::chrono::nanoseconds elapsed) {
+        BENCH_RESULT result;
+        result.name = name;
+        result.size = size;
+        result.ops = ops ? ops : 1;
+        result.totalNs = (double)elapsed.count();
+        printf("%-32s %10zu %10zu %14.1f %12.3f\n", name.c_str(), size, result.ops, result.totalNs / result.ops, result.totalNs / 1e6);
+        fflush(stdout);
+        results.push_back(std::move(result));
+    }
+
+    // Runs body once and records it as ops operations.
+    template <typename BODY>
+    void Time(const std::string& name, size_t size, size_t ops, BODY&& body) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        Add(name, size, ops, std::chrono::steady_clock::now() - start);
+    }
+
+    // Writes the JSON document if one was asked for; returns the exit code.
+    int Finish() const {
+        if (jsonPath.empty()) return 0;
+        FILE* file = fopen(jsonPath.c_str(), "w");
+        if (!file) { fprintf(stderr, "cannot write %s\n", jsonPath.c_str()); return 1; }
+        fprintf(file, "{\"suite\": \"%s\", \"quick\": %s, \"results\": [", suite.c_str(), quick ? "true" : "false");
+        for (size_t i = 0; i < results.size(); i++) {
+            const BENCH_RESULT& r = results[i];
+            fprintf(file, "%s\n  {\"name\": \"%s\", \"size\": %zu, \"ops\": %zu, \"ns_per_op\": %.3f, \"total_ms\": %.6f}",
+                i ? "," : "", r.name.c_str(), r.size, r.ops, r.totalNs / r.ops, r.totalNs / 1e6);
+        }
+        fprintf(file, "\n]}\n");
+        return fclose(file) == 0 ? 0 : 1;
+    }
+
+private:
+    std::string suite;
+    std::string jsonPath;
+    bool quick = false;
+    std::vector<BENCH_RESULT> results;
+};
@@ -0,0 +1,82 @@
+#include "Bench.h"
+#include "AutoHide.h"
+#include "SimBackend.h"
+
+#include <random>
+#include <string>
+
+// --- Auto-Hide ---
+// Focus tracking over tens of thousands of open windows: seeding at startup,
+// foreground switches, re-arming everything on a rules edit, and draining
+// the windows that came due. Rules mix class, title and catch-all matches
+// so each arm does a realistic lookup.
+
+static const char* RULES =
+    "[AutoHide]\r\n"
+    "class:Notepad=10     ; window class, exact\r\n"
+    "title:Slack=30       ; title contains\r\n"
+    "title:Build=0\r\n"
+    "*=60                 ; everything else\r\n";
+
+static std::vector<AUTO_HIDE_RULE> Rules(const char* text) {
+    Settings settings;
+    ParseSettings(text, &settings);
+    return LoadAutoHideRules(settings);
+}
+
+int main(int argc, char** argv) {
+    BenchReport report("auto_hide", argc, argv);
+    std::mt19937 rng(5);
+
+    for (size_t n : report.Sizes({ 1000, 10000, 50000, 100000 }, 1000)) {
+        SimWindowSystem windows;
+        std::vector<WINDOW_HANDLE> handles;
+        for (size_t i = 0; i < n; i++) {
+            const wchar_t* className = i % 7 == 0 ? L"Notepad" : L"SimWindow";
+            std::wstring title = (i % 5 == 0 ? L"Slack - channel " : i % 11 == 0 ? L"Build " : L"Document ") + std::to_wstring(i);
+            handles.push_back(windows.CreateSimWindow(title, (uint32_t)i, className));
+        }
+
+        FocusTracker tracker(&windows);
+        tracker.SetRules(Rules(RULES), 0);
+        report.Time("track", n, n, [&] {
+            for (size_t i = 0; i < n; i++) tracker.Track(handles[i], i % 600);
+        });
+
+        size_t switches = report.IsQuick() ? 1000 : 100000;
+        uint64_t now = 600;
+        report.Time("foreground_switch", n, switches, [&] {
+            for (size_t i = 0; i < switches; i++) tracker.OnForeground(handles[rng() % n], now + i / 100);
+        });
+        now += switches / 100;
+
+        report.Time("set_rules", n, n, [&] { tracker.SetRules(Rules("[AutoHide]\r\n*=45\r\n"), now); });
+        tracker.SetRules(Rules(RULES), now);
+
+        // Wake up at each due time, as ScheduleAutoHideTimer does, until everything is hidden
+        std::vector<WINDOW_HANDLE> due;
+        size_t wakeups = 0;
+        report.Time("collect_all", n, n, [&] {
+            while (tracker.NextDueTime() != WHEEL_NO_TIMER) {
+                tracker.Collect(tracker.NextDueTime(), &due);
+                wakeups++;
+            }
+        });
+        BenchConsume(due.size() + wakeups);
+    }
+
+    for (size_t n : report.Sizes({ 1000, 10000, 100000 }, 1000)) {
+        TimerWheel wheel;
+        std::vector<TIMER_ID> ids(n);
+        std::vector<TIMER_EXPIRY> expired;
+        report.Time("wheel_schedule", n, n, [&] {
+            for (size_t i = 0; i < n; i++) ids[i] = wheel.Schedule(1 + rng() % 86400, i);
+        });
+        report.Time("wheel_cancel", n, n / 2, [&] {
+            for (size_t i = 0; i < n; i += 2) wheel.Cancel(ids[i]);
+        });
+        report.Time("wheel_advance_day", n, n - n / 2, [&] { wheel.Advance(86400, &expired); });
+        BenchConsume(expired.size());
+    }
+    return report.Finish();
+}
@@ -0,0 +1,66 @@
+#include "Bench.h"
+#include "SimBackend.h"
+#include "TrayCore.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+// --- Core Paths ---
+// Hide, restore, restore all, startup load and list refresh against the
+// simulated backend with 10 to 100k windows already hidden. Single hides and
+// restores save the whole list each time, so they are timed over a fixed
+// sample rather than all n windows.
+
+#define SAMPLE_OPS 256
+
+struct SIM_CORE {
+    SIM_BACKEND sim;
+    CORE_STATE core;
+
+    SIM_CORE() { sim.Attach(&core); }
+};
+
+// A core with n windows hidden through the save file, as after a restart.
+static std::unique_ptr<SIM_CORE> MakeLoadedCore(size_t n) {
+    auto t = std::make_unique<SIM_CORE>();
+    std::string data;
+    for (size_t i = 0; i < n; i++) {
+        WINDOW_HANDLE window = t->sim.windows.CreateSimWindow(L"Window " + std::to_wstring(i), (uint32_t)(1000 + i % 64));
+        data += std::to_string((unsigned long long)window);
+        data += '\n';
+    }
+    t->sim.files.WriteAll(t->core.saveFile, data);
+    return t;
+}
+
+int main(int argc, char** argv) {
+    BenchReport report("core", argc, argv);
+
+    for (size_t n : report.Sizes({ 10, 100, 1000, 10000, 100000 }, 1000)) {
+        auto t = MakeLoadedCore(n);
+        report.Time("load_state", n, n, [&] { LoadState(&t->core); });
+
+        size_t ops = std::min<size_t>(n, SAMPLE_OPS);
+        std::vector<WINDOW_HANDLE> extra;
+        for (size_t i = 0; i < ops; i++) extra.push_back(t->sim.windows.CreateSimWindow(L"Extra " + std::to_wstring(i)));
+        report.Time("hide", n, ops, [&] {
+            for (WINDOW_HANDLE window : extra) {
+                t->sim.windows.SetForeground(window);
+                MinimizeToTray(&t->core);
+            }
+        });
+
+        // The newest windows, so each lookup walks the whole list
+        std::vector<unsigned> icons;
+        for (size_t i = 0; i < ops; i++) icons.push_back(t->core.hiddenWindows[t->core.hiddenWindows.size() - 1 - i].iconId);
+        report.Time("restore", n, ops, [&] { for (unsigned iconId : icons) RestoreWindow(&t->core, iconId); });
+
+        report.Time("list_refresh", n, ops, [&] {
+            for (size_t i = 0; i < ops; i++) t->sim.view.Refresh(t->core.hiddenWindows);
+        });
+        report.Time("save_state", n, ops, [&] { for (size_t i = 0; i < ops; i++) SaveState(&t->core); });
+        report.Time("restore_all", n, n, [&] { RestoreAll(&t->core); });
+    }
+    return report.Finish();
+}
@@ -0,0 +1,74 @@
+#include "Bench.h"
+#include "HotkeyNames.h"
+#include "Settings.h"
+
+#include <cwchar>
+#include <string>
+
+// --- Hotkey Names ---
+// Table rebuilds on a layout switch, formatting for the hotkey control and
+// labels, and parsing the hotkey back out of the settings file. The stand-in
+// layout answers from memory, so rebuild times exclude GetKeyNameText itself.
+
+class StandInLayout : public IKeyboardLayout {
+public:
+    uintptr_t id = 0x04090409;
+
+    uintptr_t GetLayoutId() override { return id; }
+
+    bool GetKeyName(unsigned vk, bool extended, wchar_t* buf, size_t bufLen) override {
+        if (vk < 0x20 || vk > 0x7E) return false;
+        swprintf(buf, bufLen, extended ? L"Ext %u" : L"Key %u", vk);
+        return true;
+    }
+};
+
+int main(int argc, char** argv) {
+    BenchReport report("hotkey_names", argc, argv);
+    StandInLayout layout;
+    KeyNameTable table;
+    size_t ops = report.IsQuick() ? 1000 : 200000;
+
+    size_t rebuilds = report.IsQuick() ? 100 : 10000;
+    report.Time("layout_switch", 256, rebuilds, [&] {
+        for (size_t i = 0; i < rebuilds; i++) {
+            layout.id ^= 1;
+            table.EnsureLayout(&layout);
+        }
+    });
+    report.Time("ensure_layout_same", 256, ops, [&] {
+        for (size_t i = 0; i < ops; i++) table.EnsureLayout(&layout);
+    });
+
+    wchar_t buf[HOTKEY_TEXT_MAX];
+    size_t total = 0;
+    report.Time("format_hotkey", 1, ops, [&] {
+        for (size_t i = 0; i < ops; i++) total += FormatHotkey(table, (unsigned)i & 0xF, 0x20 + (unsigned)(i % 0x5F), buf, HOTKEY_TEXT_MAX);
+    });
+    BenchConsume(total);
+
+    // The worst case looks up a key near the end of the table
+    FormatHotkey(table, HK_MOD_WIN | HK_MOD_CONTROL | HK_MOD_SHIFT | HK_MOD_ALT, 0x7E, buf, HOTKEY_TEXT_MAX);
+    unsigned mods = 0, vk = 0;
+    report.Time("parse_hotkey", 1, ops, [&] {
+        for (size_t i = 0; i < ops; i++) total += ParseHotkey(table, buf, &mods, &vk) ? vk : 0;
+    });
+    BenchConsume(total);
+
+    // ApplySettings runs on every reload of the file
+    for (size_t extra : report.Sizes({ 0, 100, 10000 }, 100)) {
+        std::string text = "[Settings]\r\nKey=90\r\nModifiers=12\r\n";
+        for (size_t i = 0; i < extra; i++) text += "Other" + std::to_string(i) + "=1\r\n";
+        Settings numeric, readable;
+        ParseSettings(text, &numeric);
+        ParseSettings("[Settings]\r\nHotkey=Win + Shift + Key 90\r\n" + text.substr(text.find("Modifiers=12\r\n") + 14), &readable);
+        report.Time("load_setting_numeric", extra, ops, [&] {
+            for (size_t i = 0; i < ops; i++) { LoadHotkeySetting(numeric, table, &mods, &vk); total += vk; }
+        });
+        report.Time("load_setting_readable", extra, ops, [&] {
+            for (size_t i = 0; i < ops; i++) { LoadHotkeySetting(readable, table, &mods, &vk); total += vk; }
+        });
+        BenchConsume(total);
+    }
+    return report.Finish();
+}
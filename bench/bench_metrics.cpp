@@ -0,0 +1,63 @@
+#include "Bench.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+
+// --- Metrics ---
+// What instrumentation costs on the hot paths (a counter bump, a histogram
+// observation, a scoped timer) and what each export costs the worker thread:
+// formatting the registry and replacing the dump file. Sizes are metrics in
+// the registry.
+
+int main(int argc, char** argv) {
+    BenchReport report("metrics", argc, argv);
+    size_t ops = report.IsQuick() ? 10000 : 10000000;
+
+    MetricsRegistry hot;
+    Counter* counter = hot.AddCounter("traycaddy_bench_total", "Bench counter.");
+    Histogram* histogram = hot.AddHistogram("traycaddy_bench_seconds", "Bench latency.", LatencyBucketsUs(), 1e-6);
+    report.Time("counter_add", 1, ops, [&] {
+        for (size_t i = 0; i < ops; i++) counter->Add();
+    });
+    report.Time("histogram_observe", 1, ops, [&] {
+        for (size_t i = 0; i < ops; i++) histogram->Observe(i & 0xFFFF);
+    });
+    size_t timers = ops / 10;
+    report.Time("histogram_timer", 1, timers, [&] {
+        for (size_t i = 0; i < timers; i++) { HistogramTimer timer(histogram); }
+    });
+    report.Time("null_timer", 1, ops, [&] {
+        for (size_t i = 0; i < ops; i++) { HistogramTimer timer(nullptr); }
+    });
+    BenchConsume(counter->Get());
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "traycaddy_bench_metrics.prom";
+    for (size_t n : report.Sizes({ 10, 100, 1000, 10000 }, 100)) {
+        MetricsRegistry registry;
+        for (size_t i = 0; i < n; i++) {
+            std::string name = "traycaddy_bench_" + std::to_string(i);
+            if (i % 10 == 0) registry.AddHistogram(name + "_seconds", "Bench latency.", LatencyBucketsUs(), 1e-6)->Observe(i);
+            else registry.AddCounter(name + "_total", "Bench counter.")->Add(i);
+        }
+
+        size_t rounds = report.IsQuick() ? 2 : std::max<size_t>(3, 100000 / n);
+        std::string text;
+        report.Time("format", n, rounds, [&] {
+            for (size_t i = 0; i < rounds; i++) { text.clear(); registry.FormatPrometheus(&text); }
+        });
+        BenchConsume(text.size());
+
+        MetricsExporter exporter(&registry);
+        exporter.Start(path.wstring(), 3600000, nullptr);
+        exporter.Stop();
+        size_t exports = report.IsQuick() ? 2 : std::max<size_t>(3, 10000 / n);
+        report.Time("export_file", n, exports, [&] {
+            for (size_t i = 0; i < exports; i++) exporter.ExportNow();
+        });
+        BenchConsume(exporter.GetExportCount());
+    }
+    std::filesystem::remove(path);
+    return report.Finish();
+}
@@ -0,0 +1,88 @@
+#include "Bench.h"
+#include "ProcessStats.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <cstdlib>
+#endif
+
+// --- Process Telemetry ---
+// One sampler pass is a batch query plus the rate computation; the UI then
+// sorts the list by cost. The /proc cases read real processes, so their
+// numbers depend on the machine; the rest use synthetic samples.
+
+#ifndef _WIN32
+static std::vector<uint32_t> RunningPids() {
+    std::vector<uint32_t> pids;
+    DIR* dir = opendir("/proc");
+    if (!dir) return pids;
+    while (dirent* entry = readdir(dir)) {
+        char* end = nullptr;
+        unsigned long pid = strtoul(entry->d_name, &end, 10);
+        if (end != entry->d_name && *end == '\0') pids.push_back((uint32_t)pid);
+    }
+    closedir(dir);
+    return pids;
+}
+#endif
+
+int main(int argc, char** argv) {
+    BenchReport report("process_stats", argc, argv);
+
+#ifndef _WIN32
+    {
+        auto stats = CreateProcessStats();
+        std::vector<uint32_t> running = RunningPids();
+        std::vector<PROCESS_SAMPLE> samples;
+        for (size_t n : report.Sizes({ 1, 10, 100 }, 10)) {
+            // Repeat the running pids to reach n; the kernel serves them from the same entries
+            std::vector<uint32_t> pids;
+            for (size_t i = 0; i < n && !running.empty(); i++) pids.push_back(running[i % running.size()]);
+            size_t rounds = report.IsQuick() ? 5 : 50;
+            report.Time("procfs_query_batch", n, rounds * n, [&] {
+                for (size_t r = 0; r < rounds; r++) stats->QueryBatch(pids, samples);
+            });
+        }
+    }
+#endif
+
+    for (size_t n : report.Sizes({ 100, 1000, 10000, 100000 }, 1000)) {
+        std::unordered_map<uint32_t, PROCESS_SAMPLE> previous;
+        std::vector<PROCESS_SAMPLE> current(n);
+        for (size_t i = 0; i < n; i++) {
+            PROCESS_SAMPLE s;
+            s.pid = (uint32_t)(i + 1);
+            s.valid = true;
+            s.cpuTime = i * 1000;
+            s.workingSet = (i * 7919) % 100000 * 4096;
+            previous[s.pid] = s;
+            s.cpuTime += (i * 31) % 5000;
+            current[i] = s;
+        }
+        std::vector<PROCESS_USAGE> usage;
+        report.Time("compute_usage", n, n, [&] { ComputeUsage(previous, current, 20000000, 8, usage); });
+
+        std::vector<USAGE_SORT_KEY> keys(n);
+        for (size_t i = 0; i < n; i++) {
+            keys[i].id = (unsigned)(1000 + i);
+            keys[i].measured = i % 10 != 0;
+            keys[i].cpuPercent = i < usage.size() ? usage[i].cpuPercent : 0.0;
+            keys[i].workingSet = i < usage.size() ? usage[i].workingSet : 0;
+        }
+        std::vector<USAGE_SORT_KEY> sorted;
+        size_t rounds = 10;
+        report.Time("sort_by_cpu", n, rounds * n, [&] {
+            for (size_t r = 0; r < rounds; r++) { sorted = keys; SortUsageKeys(sorted, ORDER_BY_CPU); }
+        });
+        BenchConsume(sorted.front().id);
+        report.Time("sort_by_memory", n, rounds * n, [&] {
+            for (size_t r = 0; r < rounds; r++) { sorted = keys; SortUsageKeys(sorted, ORDER_BY_MEMORY); }
+        });
+        BenchConsume(sorted.front().id);
+    }
+    return report.Finish();
+}
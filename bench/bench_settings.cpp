@@ -0,0 +1,73 @@
+#include "Bench.h"
+#include "Settings.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+
+// --- Settings ---
+// Parse time is what the watcher pays on every outside edit, and Load at
+// startup; lookups and rewrites are what ApplySettings and SaveSettings pay.
+// Files mix sections, comments and auto-hide rules like a large central
+// config. Sizes are entries per file.
+
+static std::string MakeConfig(size_t entries) {
+    std::string text = "; Central TrayCaddy configuration\r\n\r\n[Settings]\r\nKey=90\r\nModifiers=12\r\n";
+    for (size_t i = 0; i < entries; i++) {
+        if (i % 1000 == 0) text += "\r\n[Section" + std::to_string(i / 1000) + "]\r\n";
+        if (i % 10 == 0) text += "; Rule group " + std::to_string(i) + "\r\n";
+        text += "class:App" + std::to_string(i) + " = " + std::to_string(i % 60 + 1) + "\r\n";
+    }
+    return text;
+}
+
+int main(int argc, char** argv) {
+    BenchReport report("settings", argc, argv);
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "traycaddy_bench_settings.ini";
+
+    for (size_t n : report.Sizes({ 10, 100, 1000, 10000, 100000 }, 1000)) {
+        std::string text = MakeConfig(n);
+        size_t rounds = report.IsQuick() ? 2 : std::max<size_t>(3, 500000 / (n + 10));
+        Settings settings;
+        report.Time("parse", n, rounds, [&] {
+            for (size_t r = 0; r < rounds; r++) ParseSettings(text, &settings);
+        });
+
+        std::string out;
+        report.Time("serialize", n, rounds, [&] {
+            for (size_t r = 0; r < rounds; r++) out = SerializeSettings(settings);
+        });
+        BenchConsume(out.size());
+
+        size_t lookups = report.IsQuick() ? 1000 : 100000;
+        int total = 0;
+        report.Time("find", n, lookups, [&] {
+            for (size_t i = 0; i < lookups; i++) {
+                size_t k = i * 7919 % n;
+                total += settings.GetInt(L"Section" + std::to_wstring(k / 1000), L"class:App" + std::to_wstring(k), 0);
+            }
+        });
+        BenchConsume((uint64_t)total);
+
+        size_t sets = report.IsQuick() ? 100 : 10000;
+        report.Time("set_existing", n, sets, [&] {
+            for (size_t i = 0; i < sets; i++) settings.SetInt(L"Settings", L"Key", (int)i);
+        });
+
+        // Remove reindexes the whole document; SaveSettings does it once per save
+        size_t removes = std::min<size_t>(report.IsQuick() ? 5 : n >= 10000 ? 5 : 50, n);
+        report.Time("remove", n, removes, [&] {
+            for (size_t i = 0; i < removes; i++) settings.Remove(L"Section0", L"class:App" + std::to_wstring(i));
+        });
+
+        SettingsStore store(path.wstring());
+        report.Time("save_and_load", n, 1, [&] {
+            store.Save([&](Settings* next) { *next = settings; });
+            store.Load();
+        });
+        BenchConsume(store.Get()->GetSections().size());
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return report.Finish();
+}
@@ -0,0 +1,62 @@
+#include "Bench.h"
+#include "Thumbnail.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+// --- Thumbnails ---
+// Downscaling window captures to a 256x160 preview with the row-accumulating
+// resampler against the per-box reference, and cache traffic at a typical budget. Downscale cases count one op per
+// captured image.
+
+struct CAPTURE_SIZE {
+    int width;
+    int height;
+};
+
+int main(int argc, char** argv) {
+    BenchReport report("thumbnail", argc, argv);
+    std::mt19937 rng(42);
+
+    const CAPTURE_SIZE sizes[] = { { 640, 480 }, { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+    for (const CAPTURE_SIZE& size : sizes) {
+        if (report.IsQuick() && size.width > 640) break;
+        std::vector<uint8_t> src((size_t)size.width * size.height * 4);
+        for (auto& b : src) b = (uint8_t)rng();
+        size_t stride = (size_t)size.width * 4;
+        size_t pixels = (size_t)size.width * size.height;
+
+        int w, h;
+        FitThumbnailSize(size.width, size.height, 256, 160, &w, &h);
+        std::vector<uint16_t> dst((size_t)w * h);
+        size_t rounds = report.IsQuick() ? 2 : (size_t)std::max<size_t>(4, 200000000 / (pixels * 4));
+
+        report.Time("downscale_reference", pixels, rounds, [&] {
+            for (size_t r = 0; r < rounds; r++) DownscaleBoxScalar(src.data(), size.width, size.height, stride, dst.data(), w, h, w);
+        });
+        report.Time("downscale", pixels, rounds, [&] {
+            for (size_t r = 0; r < rounds; r++) DownscaleBox(src.data(), size.width, size.height, stride, dst.data(), w, h, w);
+        });
+        BenchConsume(dst[0]);
+    }
+
+    // 8 MB budget of 256x144 previews (about 110 fit), keys cycling over twice that
+    for (size_t keys : report.Sizes({ 100, 220, 1000 }, 220)) {
+        ThumbnailCache cache(8 * 1024 * 1024);
+        THUMBNAIL thumb;
+        thumb.width = thumb.stride = 256;
+        thumb.height = 144;
+        thumb.pixels.resize(256 * 144);
+        size_t ops = report.IsQuick() ? 1000 : 100000;
+        report.Time("cache_put_get", keys, ops, [&] {
+            for (size_t i = 0; i < ops; i++) {
+                unsigned key = (unsigned)(i * 7 % keys);
+                if (!cache.Get(key)) cache.Put(key, THUMBNAIL(thumb));
+            }
+        });
+        BenchConsume(cache.Count());
+    }
+    return report.Finish();
+}
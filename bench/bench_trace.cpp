@@ -0,0 +1,66 @@
+#include "Bench.h"
+#include "EventTrace.h"
+#include "SimBackend.h"
+#include "TraceReplay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+// --- Trace Replay ---
+// Replays captured sessions against the simulated backend, so a trace taken
+// in the field (TrayCaddy.exe /record <file>) becomes a repeatable workload:
+//
+//   bench_trace [--quick] [--json <file>] <trace.tctr>...
+//
+// Each trace is decoded, then replayed at full speed on a fresh core per
+// round; ops are recorded events. A replay whose hide outcomes differ from
+// the recording fails the run, since its timings no longer describe the
+// session. bench/traces/session.tctr is a small synthetic session in the
+// same format that ctest replays with --quick.
+
+struct SIM_CORE {
+    SIM_BACKEND sim;
+    CORE_STATE core;
+
+    SIM_CORE() { sim.Attach(&core); }
+};
+
+int main(int argc, char** argv) {
+    std::vector<std::filesystem::path> traces;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) i++;
+        else if (strncmp(argv[i], "--", 2) != 0) traces.push_back(argv[i]);
+    }
+    if (traces.empty()) { fprintf(stderr, "usage: bench_trace [--quick] [--json <file>] <trace.tctr>...\n"); return 1; }
+    BenchReport report("trace", argc, argv);
+
+    int failed = 0;
+    for (const auto& path : traces) {
+        std::string name = path.stem().string();
+        std::vector<TRACE_EVENT> events;
+        auto start = std::chrono::steady_clock::now();
+        bool loaded = LoadTrace(path.wstring(), &events);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (!loaded || events.empty()) { fprintf(stderr, "cannot load %s\n", path.string().c_str()); failed++; continue; }
+        size_t n = events.size();
+        report.Add("load_" + name, n, n, elapsed);
+
+        size_t rounds = report.IsQuick() ? 1 : std::max<size_t>(3, 2000000 / n);
+        std::vector<std::unique_ptr<SIM_CORE>> cores;
+        for (size_t r = 0; r < rounds; r++) cores.push_back(std::make_unique<SIM_CORE>());
+        TRACE_REPLAY_STATS stats;
+        report.Time("replay_" + name, n, n * rounds, [&] {
+            for (auto& t : cores) stats = ReplayTrace(events, &t->core, &t->sim, PACING_FULL_SPEED);
+        });
+        printf("  %zu events, %zu hides, %zu restores, %zu mismatches\n", stats.events, stats.hides, stats.restores, stats.mismatches);
+        if (stats.mismatches) { fprintf(stderr, "%s: replay drifted from the recording\n", path.string().c_str()); failed++; }
+    }
+    int status = report.Finish();
+    return failed ? 1 : status;
+}
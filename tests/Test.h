@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// --- Tests ---
+// Minimal harness shared by the test_* programs. TEST(name) registers a case,
+// CHECK records a failure and carries on, and RunTests runs every case and
+// returns the process exit code for ctest.
+
+struct TEST_CASE {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<TEST_CASE>& TestCases() {
+    static std::vector<TEST_CASE> cases;
+    return cases;
+}
+
+inline int& TestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*run)()) { TestCases().push_back({ name, run }); }
+};
+
+inline void ReportFailure(const char* file, int line, const char* expression) {
+    fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expression);
+    TestFailures()++;
+}
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistrar name##Registrar(#name, name); \
+    static void name()
+
+#define CHECK(cond) do { if (!(cond)) ReportFailure(__FILE__, __LINE__, #cond); } while (0)
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+inline int RunTests() {
+    int failedCases = 0;
+    for (const auto& test : TestCases()) {
+        int before = TestFailures();
+        test.run();
+        bool passed = TestFailures() == before;
+        if (!passed) failedCases++;
+        printf("%s %s\n", passed ? "[ OK ]  " : "[FAIL]  ", test.name);
+    }
+    printf("%zu cases, %d failed\n", TestCases().size(), failedCases);
+    return failedCases ? 1 : 0;
+}
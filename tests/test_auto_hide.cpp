@@ -0,0 +1,174 @@
+#include "Test.h"
+#include "AutoHide.h"
+#include "SimBackend.h"
+
+#include <string>
+#include <unordered_map>
+
+// --- Rules ---
+
+static std::vector<AUTO_HIDE_RULE> RulesFrom(const char* text) {
+    Settings settings;
+    ParseSettings(text, &settings);
+    return LoadAutoHideRules(settings);
+}
+
+TEST(DocumentedExampleParses) {
+    // Verbatim from AutoHide.h, inline comments included
+    std::vector<AUTO_HIDE_RULE> rules = RulesFrom(
+        "[AutoHide]\r\n"
+        "class:Notepad=10     ; window class, exact\r\n"
+        "title:Slack=30       ; title contains\r\n"
+        "*=60                 ; everything else\r\n");
+    CHECK_EQ(rules.size(), 3u);
+    if (rules.size() != 3) return;
+    CHECK(rules[0].match == MATCH_CLASS && rules[0].pattern == L"notepad" && rules[0].idleMinutes == 10);
+    CHECK(rules[1].match == MATCH_TITLE && rules[1].pattern == L"slack" && rules[1].idleMinutes == 30);
+    CHECK(rules[2].match == MATCH_ANY && rules[2].idleMinutes == 60);
+}
+
+TEST(BadRulesAreSkipped) {
+    AUTO_HIDE_RULE rule;
+    CHECK(ParseAutoHideRule(L"title:Mail", L"0;exempt", &rule) && rule.idleMinutes == 0);
+    CHECK(ParseAutoHideRule(L"*", L"10\t; tab before the comment", &rule) && rule.idleMinutes == 10);
+    CHECK(!ParseAutoHideRule(L"*", L"", &rule));
+    CHECK(!ParseAutoHideRule(L"*", L"; only a comment", &rule));
+    CHECK(!ParseAutoHideRule(L"*", L"ten", &rule));
+    CHECK(!ParseAutoHideRule(L"*", L"10 minutes", &rule));
+    CHECK(!ParseAutoHideRule(L"*", L"20000", &rule)); // Over a week
+    CHECK(!ParseAutoHideRule(L"class:", L"10", &rule));
+    CHECK(!ParseAutoHideRule(L"process:code.exe", L"10", &rule));
+}
+
+TEST(FirstMatchingRuleWins) {
+    std::vector<AUTO_HIDE_RULE> rules = RulesFrom("[AutoHide]\nclass:Notepad=0\ntitle:slack=30\nTITLE:Mail=5\n*=60\n");
+    CHECK_EQ(MatchAutoHideRule(rules, L"notepad", L"Slack"), 0u); // Exempt
+    CHECK_EQ(MatchAutoHideRule(rules, L"Chrome_WidgetWin_1", L"#general - SLACK"), 30u);
+    CHECK_EQ(MatchAutoHideRule(rules, L"Chrome_WidgetWin_1", L"Inbox - Mail"), 5u);
+    CHECK_EQ(MatchAutoHideRule(rules, L"Other", L"Other"), 60u);
+    CHECK_EQ(MatchAutoHideRule({}, L"Other", L"Other"), 0u);
+}
+
+// --- Focus Tracker ---
+
+struct TRACKER {
+    SimWindowSystem windows;
+    FocusTracker tracker{ &windows };
+
+    TRACKER(const char* rules) { tracker.SetRules(RulesFrom(rules), 0); }
+
+    std::vector<WINDOW_HANDLE> Collect(uint64_t nowSec) {
+        std::vector<WINDOW_HANDLE> due;
+        tracker.Collect(nowSec, &due);
+        return due;
+    }
+};
+
+TEST(BackgroundWindowsHideAfterTheirMinutes) {
+    TRACKER t("[AutoHide]\nclass:Notepad=1\n*=2\n");
+    CHECK(t.tracker.IsEnabled());
+    WINDOW_HANDLE notes = t.windows.CreateSimWindow(L"Notes", 1, L"Notepad");
+    WINDOW_HANDLE other = t.windows.CreateSimWindow(L"Other", 2);
+    t.tracker.Track(notes, 100);
+    t.tracker.Track(other, 100);
+    CHECK_EQ(t.tracker.ArmedCount(), 2u);
+    CHECK_EQ(t.tracker.NextDueTime(), 160u);
+
+    CHECK(t.Collect(159).empty());
+    CHECK(t.Collect(160) == std::vector<WINDOW_HANDLE>({ notes }));
+    CHECK(t.Collect(219).empty());
+    CHECK(t.Collect(220) == std::vector<WINDOW_HANDLE>({ other }));
+    CHECK_EQ(t.tracker.TrackedCount(), 0u);
+    CHECK_EQ(t.tracker.NextDueTime(), WHEEL_NO_TIMER);
+}
+
+TEST(FocusRestartsTheIdleClock) {
+    TRACKER t("[AutoHide]\n*=1\n");
+    WINDOW_HANDLE a = t.windows.CreateSimWindow(L"A");
+    WINDOW_HANDLE b = t.windows.CreateSimWindow(L"B");
+    t.tracker.OnForeground(a, 0);
+    CHECK_EQ(t.tracker.ArmedCount(), 0u); // The foreground window never idles
+    t.tracker.OnForeground(b, 30);        // A idles from 30
+    t.tracker.OnForeground(a, 80);        // B idles from 80, A is back
+    CHECK(t.Collect(100).empty());
+    CHECK(t.Collect(140) == std::vector<WINDOW_HANDLE>({ b }));
+
+    // Focus on the desktop or taskbar still starts A's clock
+    t.tracker.OnForeground(0, 200);
+    CHECK(t.Collect(259).empty());
+    CHECK(t.Collect(260) == std::vector<WINDOW_HANDLE>({ a }));
+}
+
+TEST(TitleIsCheckedAgainWhenDue) {
+    TRACKER t("[AutoHide]\ntitle:Slack=1\ntitle:Build=3\n");
+    WINDOW_HANDLE w = t.windows.CreateSimWindow(L"Slack");
+    t.tracker.Track(w, 0);
+    t.windows.SetSimTitle(w, L"Build running");
+    CHECK(t.Collect(60).empty()); // Now under the 3 minute rule
+    CHECK_EQ(t.tracker.ArmedCount(), 1u);
+    CHECK(t.Collect(180) == std::vector<WINDOW_HANDLE>({ w }));
+
+    WINDOW_HANDLE x = t.windows.CreateSimWindow(L"Slack");
+    t.tracker.Track(x, 200);
+    t.windows.SetSimTitle(x, L"Unmatched");
+    CHECK(t.Collect(1000).empty()); // No rule any more: left alone
+    CHECK_EQ(t.tracker.ArmedCount(), 0u);
+}
+
+TEST(ClosedAndForgottenWindowsAreDropped) {
+    TRACKER t("[AutoHide]\n*=1\n");
+    WINDOW_HANDLE closed = t.windows.CreateSimWindow(L"Closed");
+    WINDOW_HANDLE forgotten = t.windows.CreateSimWindow(L"Forgotten");
+    t.tracker.Track(closed, 0);
+    t.tracker.Track(forgotten, 0);
+    t.windows.DestroySimWindow(closed);
+    t.tracker.Forget(forgotten);
+    CHECK_EQ(t.tracker.ArmedCount(), 1u);
+    CHECK(t.Collect(60).empty());
+    CHECK_EQ(t.tracker.TrackedCount(), 0u);
+}
+
+TEST(NewRulesKeepIdleStart) {
+    TRACKER t("[AutoHide]\n*=10\n");
+    WINDOW_HANDLE w = t.windows.CreateSimWindow(L"W");
+    t.tracker.Track(w, 0);
+    t.tracker.SetRules(RulesFrom("[AutoHide]\n*=2\n"), 100);
+    CHECK_EQ(t.tracker.NextDueTime(), 120u);
+
+    t.tracker.SetRules(RulesFrom("[AutoHide]\n*=0\n"), 110);
+    CHECK(!t.tracker.IsEnabled());
+    CHECK_EQ(t.tracker.ArmedCount(), 0u);
+
+    t.tracker.SetRules(RulesFrom("[AutoHide]\n*=1\n"), 130); // Idle since 0, so due at once
+    CHECK(t.Collect(131) == std::vector<WINDOW_HANDLE>({ w }));
+}
+
+TEST(ManyWindowsComeDueOnTime) {
+    TRACKER t("[AutoHide]\n*=1\n");
+    std::unordered_map<WINDOW_HANDLE, uint64_t> idleSince;
+    for (int i = 0; i < 20000; i++) {
+        WINDOW_HANDLE w = t.windows.CreateSimWindow(L"W" + std::to_wstring(i));
+        t.tracker.Track(w, (uint64_t)i / 10);
+        idleSince[w] = (uint64_t)i / 10;
+    }
+    CHECK_EQ(t.tracker.ArmedCount(), 20000u);
+
+    size_t early = 0, late = 0, collected = 0;
+    uint64_t previous = 0;
+    for (uint64_t now = 60; now <= 60 + 2010; now += 7) {
+        for (WINDOW_HANDLE w : t.Collect(now)) {
+            uint64_t due = idleSince[w] + 60;
+            if (due > now) early++;
+            if (due <= previous) late++; // Should have come in an earlier pass
+            idleSince.erase(w);
+            collected++;
+        }
+        previous = now;
+    }
+    CHECK_EQ(collected, 20000u);
+    CHECK(idleSince.empty());
+    CHECK_EQ(early, 0u);
+    CHECK_EQ(late, 0u);
+}
+
+int main() { return RunTests(); }
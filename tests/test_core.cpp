@@ -0,0 +1,146 @@
+#include "Test.h"
+#include "Metrics.h"
+#include "SimBackend.h"
+#include "TrayCore.h"
+
+#include <string>
+
+// --- Fixture ---
+
+struct SIM_CORE {
+    SIM_BACKEND sim;
+    CORE_STATE core;
+
+    SIM_CORE() { sim.Attach(&core); }
+
+    WINDOW_HANDLE HideNew(const std::wstring& title) {
+        WINDOW_HANDLE window = sim.windows.CreateSimWindow(title);
+        sim.windows.SetForeground(window);
+        return MinimizeToTray(&core) ? window : 0;
+    }
+
+    std::string SaveFile() {
+        std::string data;
+        sim.files.ReadAll(core.saveFile, &data);
+        return data;
+    }
+};
+
+// --- Hide / Restore ---
+
+TEST(HideForegroundWindow) {
+    SIM_CORE t;
+    WINDOW_HANDLE window = t.HideNew(L"Notes");
+    CHECK(window != 0);
+    CHECK_EQ(t.core.hiddenWindows.size(), 1u);
+    CHECK_EQ(t.core.hiddenWindows[0].title, std::wstring(L"Notes"));
+    CHECK(!t.sim.windows.Find(window)->visible);
+    CHECK_EQ(t.sim.tray.Count(), 1u);
+    CHECK_EQ(t.SaveFile(), std::to_string((unsigned long long)window) + "\n");
+    CHECK_EQ(t.sim.view.rows.size(), 1u);
+}
+
+TEST(RejectsShellAndOwnWindows) {
+    SIM_CORE t;
+    for (const wchar_t* className : { L"Progman", L"WorkerW", L"Shell_TrayWnd" }) {
+        t.sim.windows.SetForeground(t.sim.windows.CreateSimWindow(L"Shell", 0, className));
+        CHECK(!MinimizeToTray(&t.core));
+    }
+    t.core.ownWindow = t.sim.windows.CreateSimWindow(L"TrayCaddy");
+    t.sim.windows.SetForeground(t.core.ownWindow);
+    CHECK(!MinimizeToTray(&t.core));
+    t.sim.windows.SetForeground(0);
+    CHECK(!MinimizeToTray(&t.core));
+    CHECK(t.core.hiddenWindows.empty());
+    CHECK_EQ(t.sim.tray.addCount, 0u);
+}
+
+TEST(TrayFailureLeavesWindowAlone) {
+    SIM_CORE t;
+    MetricsRegistry registry;
+    RegisterCoreMetrics(&registry, &t.core.metrics);
+    t.sim.tray.failAdds = true;
+    WINDOW_HANDLE window = t.sim.windows.CreateSimWindow(L"Busy");
+    t.sim.windows.SetForeground(window);
+    CHECK(!MinimizeToTray(&t.core));
+    CHECK(t.sim.windows.Find(window)->visible);
+    CHECK(t.core.hiddenWindows.empty());
+    CHECK_EQ(t.core.metrics.hideFailures->Get(), 1u);
+    CHECK_EQ(t.core.metrics.hides->Get(), 0u);
+}
+
+TEST(RestoreWindowByIconId) {
+    SIM_CORE t;
+    WINDOW_HANDLE a = t.HideNew(L"A");
+    WINDOW_HANDLE b = t.HideNew(L"B");
+    unsigned iconA = t.core.hiddenWindows[0].iconId;
+    RestoreWindow(&t.core, iconA);
+    CHECK(t.sim.windows.Find(a)->visible);
+    CHECK(!t.sim.windows.Find(b)->visible);
+    CHECK_EQ(t.sim.windows.GetForeground(), a);
+    CHECK(FindHiddenWindow(&t.core, iconA) == nullptr);
+    CHECK_EQ(t.sim.tray.Count(), 1u);
+    CHECK_EQ(t.SaveFile(), std::to_string((unsigned long long)b) + "\n");
+
+    RestoreWindow(&t.core, 12345); // Unknown ids are ignored
+    CHECK_EQ(t.core.hiddenWindows.size(), 1u);
+}
+
+TEST(RestoreAllClearsStateAndFile) {
+    SIM_CORE t;
+    for (int i = 0; i < 5; i++) t.HideNew(L"W" + std::to_wstring(i));
+    RestoreAll(&t.core);
+    CHECK(t.core.hiddenWindows.empty());
+    CHECK_EQ(t.sim.tray.Count(), 0u);
+    CHECK(!t.sim.files.Exists(t.core.saveFile));
+    CHECK(t.sim.view.rows.empty());
+}
+
+TEST(ReaddDropsClosedWindows) {
+    SIM_CORE t;
+    WINDOW_HANDLE a = t.HideNew(L"A");
+    t.HideNew(L"B");
+    t.sim.windows.DestroySimWindow(a);
+    size_t adds = t.sim.tray.addCount;
+    ReaddHiddenIcons(&t.core);
+    CHECK_EQ(t.core.hiddenWindows.size(), 1u);
+    CHECK_EQ(t.core.hiddenWindows[0].title, std::wstring(L"B"));
+    CHECK_EQ(t.sim.tray.addCount, adds + 1);
+    CHECK_EQ(t.sim.view.rows.size(), 1u);
+}
+
+// --- Persistence ---
+
+TEST(LoadStateHidesSavedWindows) {
+    SIM_CORE t;
+    WINDOW_HANDLE a = t.sim.windows.CreateSimWindow(L"A");
+    WINDOW_HANDLE b = t.sim.windows.CreateSimWindow(L"B");
+    std::string data = std::to_string((unsigned long long)a) + "\r\n999\r\n" + std::to_string((unsigned long long)b) + "\r\n";
+    t.sim.files.WriteAll(t.core.saveFile, data);
+    size_t writes = t.sim.files.writeCount;
+
+    LoadState(&t.core);
+    CHECK_EQ(t.core.hiddenWindows.size(), 2u); // 999 is not a window
+    CHECK(!t.sim.windows.Find(a)->visible && !t.sim.windows.Find(b)->visible);
+    CHECK_EQ(t.sim.files.writeCount, writes); // The file is already current
+    CHECK_EQ(t.sim.view.refreshCount, 1u);    // Once for the batch, not per window
+    CHECK_EQ(t.sim.view.rows.size(), 2u);
+}
+
+TEST(LoadStateWithoutFile) {
+    SIM_CORE t;
+    LoadState(&t.core);
+    CHECK(t.core.hiddenWindows.empty());
+    CHECK_EQ(t.sim.view.refreshCount, 0u);
+}
+
+TEST(SaveSkipsClosedWindows) {
+    SIM_CORE t;
+    WINDOW_HANDLE a = t.HideNew(L"A");
+    WINDOW_HANDLE b = t.HideNew(L"B");
+    t.sim.windows.DestroySimWindow(a);
+    SaveState(&t.core);
+    CHECK_EQ(t.SaveFile(), std::to_string((unsigned long long)b) + "\n");
+}
+
+int main() { return RunTests(); }
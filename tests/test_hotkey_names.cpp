@@ -0,0 +1,191 @@
+#include "Test.h"
+#include "HotkeyNames.h"
+#include "Settings.h"
+
+#include <cwchar>
+#include <string>
+
+// --- Stand-in Layout ---
+
+// Letters and digits name themselves, plus a few named keys as a US layout
+// reports them. The German variant swaps Y and Z and renames some keys.
+class StandInLayout : public IKeyboardLayout {
+public:
+    bool german = false;
+    int lookups = 0;
+
+    uintptr_t GetLayoutId() override { return german ? 0x04070407 : 0x04090409; }
+
+    bool GetKeyName(unsigned vk, bool extended, wchar_t* buf, size_t bufLen) override {
+        lookups++;
+        std::wstring name;
+        if ((vk >= 'A' && vk <= 'Z') || (vk >= '0' && vk <= '9')) {
+            wchar_t ch = (wchar_t)vk;
+            if (german && ch == L'Y') ch = L'Z';
+            else if (german && ch == L'Z') ch = L'Y';
+            name.assign(1, ch);
+        }
+        else if (vk >= 0x70 && vk <= 0x7B) name = L"F" + std::to_wstring(vk - 0x6F);
+        else if (vk == 0x20) name = german ? L"Leer" : L"Space";
+        else if (vk == 0x2E) name = extended ? (german ? L"Entf" : L"Delete") : L"Num Del";
+        else if (vk == 0x6B) name = L"Num +";
+        else if (vk == 0x10) name = L"Shift";
+        else return false;
+        wcsncpy(buf, name.c_str(), bufLen - 1);
+        buf[bufLen - 1] = L'\0';
+        return true;
+    }
+};
+
+struct NAMES {
+    StandInLayout layout;
+    KeyNameTable table;
+
+    NAMES() { table.EnsureLayout(&layout); }
+};
+
+static std::wstring Format(const KeyNameTable& table, unsigned modifiers, unsigned vk, size_t bufLen = HOTKEY_TEXT_MAX) {
+    wchar_t buf[HOTKEY_TEXT_MAX];
+    size_t len = FormatHotkey(table, modifiers, vk, buf, bufLen);
+    CHECK_EQ(len, wcslen(buf));
+    return buf;
+}
+
+static Settings ParseText(const char* text) {
+    Settings settings;
+    ParseSettings(text, &settings);
+    return settings;
+}
+
+// --- Key Name Table ---
+
+TEST(TableFollowsLayout) {
+    NAMES n;
+    CHECK(std::wstring(n.table.GetName('Z')) == L"Z");
+    CHECK(std::wstring(n.table.GetName(0x2E)) == L"Delete"); // Looked up with the extended bit
+    CHECK(n.table.GetName(0x07) == nullptr);
+    CHECK(n.table.GetName(999) == nullptr);
+
+    int lookups = n.layout.lookups;
+    n.table.EnsureLayout(&n.layout);
+    CHECK_EQ(n.layout.lookups, lookups); // Same layout, no rebuild
+
+    n.layout.german = true;
+    n.table.EnsureLayout(&n.layout);
+    CHECK(std::wstring(n.table.GetName('Z')) == L"Y");
+    CHECK(std::wstring(n.table.GetName(0x2E)) == L"Entf");
+    CHECK_EQ(n.table.FindKey(L"leer", 4), 0x20u);
+    CHECK_EQ(n.table.FindKey(L"", 0), 0u);
+}
+
+// --- Formatting ---
+
+TEST(FormatsInDisplayOrder) {
+    NAMES n;
+    CHECK(Format(n.table, HK_MOD_ALT | HK_MOD_SHIFT | HK_MOD_WIN | HK_MOD_CONTROL, 'Z') == L"Win + Ctrl + Shift + Alt + Z");
+    CHECK(Format(n.table, HK_MOD_WIN | HK_MOD_SHIFT, 0x2E) == L"Win + Shift + Delete");
+    CHECK(Format(n.table, 0, 0x07) == L"Unknown");
+    CHECK(Format(n.table, HK_MOD_CONTROL, 0) == L"Ctrl + None");
+}
+
+TEST(FormatTruncatesToBuffer) {
+    NAMES n;
+    CHECK(Format(n.table, HK_MOD_WIN | HK_MOD_SHIFT, 'Z', 8) == L"Win + S");
+    CHECK(Format(n.table, HK_MOD_WIN, 'Z', 1) == L"");
+    wchar_t untouched = L'x';
+    CHECK_EQ(FormatHotkey(n.table, HK_MOD_WIN, 'Z', &untouched, 0), 0u);
+    CHECK(untouched == L'x');
+}
+
+// --- Parsing ---
+
+TEST(ParseInvertsFormat) {
+    NAMES n;
+    for (unsigned mods = 0; mods < 16; mods++) {
+        for (unsigned vk : { (unsigned)'A', (unsigned)'Z', 0x20u, 0x2Eu, 0x6Bu, 0x7Bu }) {
+            unsigned parsedMods = 0, parsedVk = 0;
+            CHECK(ParseHotkey(n.table, Format(n.table, mods, vk).c_str(), &parsedMods, &parsedVk));
+            CHECK_EQ(parsedMods, mods);
+            CHECK_EQ(parsedVk, vk);
+        }
+    }
+}
+
+TEST(ParseAcceptsAliasesAndHexKeys) {
+    NAMES n;
+    unsigned mods = 0, vk = 0;
+    CHECK(ParseHotkey(n.table, L"  control+ALT +  space ", &mods, &vk));
+    CHECK(mods == (HK_MOD_CONTROL | HK_MOD_ALT) && vk == 0x20);
+    CHECK(ParseHotkey(n.table, L"Ctrl + Num +", &mods, &vk)); // The key name itself ends in '+'
+    CHECK(mods == HK_MOD_CONTROL && vk == 0x6B);
+    CHECK(ParseHotkey(n.table, L"Win + 0x5a", &mods, &vk));
+    CHECK(mods == HK_MOD_WIN && vk == 0x5A);
+}
+
+TEST(ParseRejectsBadInput) {
+    NAMES n;
+    unsigned mods = 7, vk = 7;
+    CHECK(!ParseHotkey(n.table, L"", &mods, &vk));
+    CHECK(!ParseHotkey(n.table, L"Ctrl +", &mods, &vk));
+    CHECK(!ParseHotkey(n.table, L"Win + Shift", &mods, &vk)); // A modifier is never the key
+    CHECK(!ParseHotkey(n.table, L"Win + 0x100", &mods, &vk));
+    CHECK(!ParseHotkey(n.table, L"Win + Nope", &mods, &vk));
+    CHECK(mods == 7 && vk == 7);
+}
+
+// --- Hotkey Setting ---
+
+TEST(NumericPairWinsOverReadableLine) {
+    // Key/Modifiers edited centrally after the app last saved: Win + Shift + A
+    NAMES n;
+    Settings settings = ParseText("[Settings]\r\nKey=0x41\r\nModifiers=12\r\nHotkey=Ctrl + Alt + H\r\n");
+    unsigned mods = HK_MOD_WIN | HK_MOD_SHIFT, vk = 'Z';
+    LoadHotkeySetting(settings, n.table, &mods, &vk);
+    CHECK_EQ(vk, (unsigned)'A');
+    CHECK_EQ(mods, (unsigned)(HK_MOD_WIN | HK_MOD_SHIFT));
+
+    // Either number alone still counts; the other keeps its default
+    settings = ParseText("[Settings]\r\nKey=72\r\nHotkey=Ctrl + Alt + J\r\n");
+    mods = HK_MOD_WIN | HK_MOD_SHIFT;
+    vk = 'Z';
+    LoadHotkeySetting(settings, n.table, &mods, &vk);
+    CHECK_EQ(vk, (unsigned)'H');
+    CHECK_EQ(mods, (unsigned)(HK_MOD_WIN | HK_MOD_SHIFT));
+}
+
+TEST(ReadableLineAloneIsUsed) {
+    NAMES n;
+    unsigned mods = HK_MOD_WIN | HK_MOD_SHIFT, vk = 'Z';
+    LoadHotkeySetting(ParseText("[settings]\r\nhotkey = Ctrl + Alt + H\r\n"), n.table, &mods, &vk);
+    CHECK_EQ(vk, (unsigned)'H');
+    CHECK_EQ(mods, (unsigned)(HK_MOD_CONTROL | HK_MOD_ALT));
+
+    // Unparseable or absent: defaults stay
+    mods = HK_MOD_WIN;
+    vk = 'Z';
+    LoadHotkeySetting(ParseText("[Settings]\r\nHotkey=Hyper + Q\r\n"), n.table, &mods, &vk);
+    CHECK(mods == HK_MOD_WIN && vk == 'Z');
+    LoadHotkeySetting(Settings(), n.table, &mods, &vk);
+    CHECK(mods == HK_MOD_WIN && vk == 'Z');
+}
+
+TEST(StoreWritesOneCopy) {
+    NAMES n;
+    Settings settings = ParseText("[Settings]\r\nHotkey=Ctrl + Alt + H\r\nSortMode=1\r\n");
+    StoreHotkeySetting(&settings, HK_MOD_WIN | HK_MOD_ALT, 'K');
+    CHECK(settings.Find(L"Settings", L"Hotkey") == nullptr);
+    CHECK_EQ(settings.GetInt(L"Settings", L"Key", 0), 'K');
+    CHECK_EQ(settings.GetInt(L"Settings", L"Modifiers", 0), HK_MOD_WIN | HK_MOD_ALT);
+    CHECK_EQ(settings.GetInt(L"Settings", L"SortMode", 0), 1);
+
+    // What was stored reads back under any layout
+    n.layout.german = true;
+    n.table.EnsureLayout(&n.layout);
+    Settings reread;
+    ParseSettings(SerializeSettings(settings), &reread);
+    unsigned mods = 0, vk = 0;
+    LoadHotkeySetting(reread, n.table, &mods, &vk);
+    CHECK(mods == (HK_MOD_WIN | HK_MOD_ALT) && vk == 'K');
+}
+
+int main() { return RunTests(); }
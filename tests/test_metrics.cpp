@@ -0,0 +1,288 @@
+#include "Test.h"
+#include "Metrics.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// --- Helpers ---
+
+static std::string ReadAll(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static bool Contains(const std::string& text, const std::string& part) { return text.find(part) != std::string::npos; }
+
+// A registry whose dump is far bigger than a pipe buffer (64 KB on Linux)
+static void FillRegistry(MetricsRegistry* registry, size_t counters) {
+    for (size_t i = 0; i < counters; i++) {
+        registry->AddCounter("traycaddy_filler_" + std::to_string(i) + "_total", "Filler counter to make the dump large.")->Add(i);
+    }
+}
+
+// --- Values ---
+
+TEST(HistogramBucketsByUpperBound) {
+    Histogram h({ 10, 100, 50, 1000 }, 1e-6); // 50 is out of order and dropped
+    CHECK_EQ(h.GetBoundCount(), 3u);
+    for (uint64_t v : { 0, 10, 11, 100, 1000, 1001, 5000 }) h.Observe(v);
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0, sum = 0;
+    h.Snapshot(&counts, &total, &sum);
+    CHECK(counts == std::vector<uint64_t>({ 2, 2, 1, 2 })); // Bounds are inclusive; the last is +Inf
+    CHECK_EQ(total, 7u);
+    CHECK_EQ(sum, 7122u);
+}
+
+TEST(HistogramCapsBucketCount) {
+    std::vector<uint64_t> bounds;
+    for (uint64_t i = 1; i <= 100; i++) bounds.push_back(i);
+    Histogram h(bounds, 1.0);
+    CHECK_EQ(h.GetBoundCount(), (size_t)HISTOGRAM_MAX_BUCKETS - 1);
+}
+
+TEST(NullTimerDoesNothing) {
+    { HistogramTimer timer(nullptr); }
+    Histogram h(LatencyBucketsUs(), 1e-6);
+    { HistogramTimer timer(&h); }
+    std::vector<uint64_t> counts;
+    uint64_t total = 0, sum = 0;
+    h.Snapshot(&counts, &total, &sum);
+    CHECK_EQ(total, 1u);
+}
+
+// --- Registry ---
+
+TEST(FormatsPrometheusText) {
+    MetricsRegistry registry;
+    registry.AddCounter("traycaddy_hides_total", "Windows hidden.")->Add(3);
+    registry.AddGauge("traycaddy_hidden_windows", "Windows hidden now.")->Set(-2);
+    Histogram* h = registry.AddHistogram("traycaddy_hide_seconds", "Hide latency.", { 500, 2500 }, 1e-6);
+    h->Observe(400);
+    h->Observe(3000);
+
+    std::string text;
+    registry.FormatPrometheus(&text);
+    CHECK(text ==
+        "# HELP traycaddy_hides_total Windows hidden.\n"
+        "# TYPE traycaddy_hides_total counter\n"
+        "traycaddy_hides_total 3\n"
+        "# HELP traycaddy_hidden_windows Windows hidden now.\n"
+        "# TYPE traycaddy_hidden_windows gauge\n"
+        "traycaddy_hidden_windows -2\n"
+        "# HELP traycaddy_hide_seconds Hide latency.\n"
+        "# TYPE traycaddy_hide_seconds histogram\n"
+        "traycaddy_hide_seconds_bucket{le=\"0.0005\"} 1\n"
+        "traycaddy_hide_seconds_bucket{le=\"0.0025\"} 1\n"
+        "traycaddy_hide_seconds_bucket{le=\"+Inf\"} 2\n"
+        "traycaddy_hide_seconds_sum 0.0034\n"
+        "traycaddy_hide_seconds_count 2\n");
+}
+
+TEST(LongLinesAreNotCut) {
+    MetricsRegistry registry;
+    std::string name = "traycaddy_" + std::string(300, 'x') + "_seconds";
+    std::string help(400, 'h');
+    registry.AddHistogram(name, help, { 500 }, 1e-6)->Observe(400);
+
+    std::string text;
+    registry.FormatPrometheus(&text);
+    CHECK(Contains(text, "# HELP " + name + " " + help + "\n# TYPE " + name + " histogram\n"));
+    CHECK(Contains(text, "\n" + name + "_bucket{le=\"0.0005\"} 1\n"));
+    CHECK(Contains(text, "\n" + name + "_count 1\n"));
+    CHECK_EQ(text.back(), '\n');
+}
+
+TEST(HelpTextIsEscaped) {
+    MetricsRegistry registry;
+    registry.AddGauge("traycaddy_path", "Under C:\\Tray\nsecond line.");
+    std::string text;
+    registry.FormatPrometheus(&text);
+    CHECK(Contains(text, "# HELP traycaddy_path Under C:\\\\Tray\\nsecond line.\n# TYPE traycaddy_path gauge\n"));
+}
+
+TEST(BadAndDuplicateNamesAreRejected) {
+    MetricsRegistry registry;
+    CHECK(registry.AddCounter("", "Empty.") == nullptr);
+    CHECK(registry.AddCounter("1st_total", "Leading digit.") == nullptr);
+    CHECK(registry.AddGauge("tray-caddy", "Dash.") == nullptr);
+    CHECK(registry.AddGauge("tray caddy", "Space.") == nullptr);
+    CHECK(registry.AddHistogram("tray{le}", "Brace.", { 1 }, 1.0) == nullptr);
+    CHECK(registry.AddCounter("_tray:caddy_9", "All allowed characters.") != nullptr);
+
+    CHECK(registry.AddCounter("traycaddy_hides_total", "First.") != nullptr);
+    CHECK(registry.AddCounter("traycaddy_hides_total", "Again.") == nullptr);
+    CHECK(registry.AddGauge("traycaddy_hides_total", "Other type.") == nullptr);
+
+    std::string text;
+    registry.FormatPrometheus(&text);
+    CHECK(Contains(text, "# HELP traycaddy_hides_total First.\n"));
+    CHECK(!Contains(text, "Again.") && !Contains(text, "Other type.") && !Contains(text, "Dash."));
+}
+
+TEST(ConcurrentUpdatesAreNotLost) {
+    MetricsRegistry registry;
+    Counter* counter = registry.AddCounter("c_total", "c");
+    Histogram* h = registry.AddHistogram("h_seconds", "h", LatencyBucketsUs(), 1e-6);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 100000; i++) { counter->Add(); h->Observe((uint64_t)i % 2000); }
+        });
+    }
+    std::string text;
+    for (int i = 0; i < 20; i++) { text.clear(); registry.FormatPrometheus(&text); } // Scrapes alongside
+    for (auto& thread : threads) thread.join();
+    CHECK_EQ(counter->Get(), 400000u);
+    std::vector<uint64_t> counts;
+    uint64_t total = 0, sum = 0;
+    h->Snapshot(&counts, &total, &sum);
+    CHECK_EQ(total, 400000u);
+}
+
+// --- Exporter ---
+
+TEST(FileDumpsAreReplacedWhole) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "traycaddy_test_metrics.prom";
+    MetricsRegistry registry;
+    Counter* counter = registry.AddCounter("traycaddy_hides_total", "Windows hidden.");
+    int collects = 0;
+    MetricsExporter exporter(&registry);
+    exporter.Start(path.wstring(), 60000, [&] { collects++; counter->Add(); });
+    while (exporter.GetExportCount() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    exporter.Stop();
+    CHECK(!exporter.IsRunning());
+    CHECK_EQ(collects, 1);
+    CHECK(Contains(ReadAll(path), "traycaddy_hides_total 1\n"));
+
+    CHECK(exporter.ExportNow());
+    CHECK(Contains(ReadAll(path), "traycaddy_hides_total 2\n"));
+    CHECK_EQ(exporter.GetExportCount(), 2u);
+    std::filesystem::remove(path);
+}
+
+#ifndef _WIN32
+
+struct FIFO {
+    std::filesystem::path path;
+
+    FIFO(const char* name) : path(std::filesystem::temp_directory_path() / name) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        mkfifo(path.c_str(), 0600);
+    }
+    ~FIFO() {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+};
+
+static double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(FifoWithoutReaderIsSkipped) {
+    FIFO fifo("traycaddy_test_noreader.fifo");
+    auto start = std::chrono::steady_clock::now();
+    CHECK(!WriteMetricsText(fifo.path.wstring(), "x 1\n"));
+    CHECK(SecondsSince(start) < 0.5);
+}
+
+TEST(FifoReaderGetsWholeDump) {
+    FIFO fifo("traycaddy_test_reader.fifo");
+    MetricsRegistry registry;
+    FillRegistry(&registry, 5000);
+    std::string text;
+    registry.FormatPrometheus(&text);
+    CHECK(text.size() > 256 * 1024);
+
+    int fd = open(fifo.path.c_str(), O_RDONLY | O_NONBLOCK);
+    std::string received;
+    std::thread reader([&] {
+        char buf[4096];
+        for (;;) {
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n > 0) received.append(buf, (size_t)n);
+            else if (n == 0 && received.size() >= text.size()) break;
+            else std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+    CHECK(WriteMetricsText(fifo.path.wstring(), text));
+    reader.join();
+    close(fd);
+    CHECK(received == text);
+}
+
+TEST(ReaderClosingMidDumpDropsIt) {
+    FIFO fifo("traycaddy_test_closed.fifo");
+    MetricsRegistry registry;
+    FillRegistry(&registry, 2000);
+    std::string text;
+    registry.FormatPrometheus(&text);
+
+    // The reader keeps the pipe drained and hangs up partway, so the writer is often
+    // between writes rather than waiting in poll when it goes; the next write then
+    // fails with EPIPE, and the default SIGPIPE action would end this test process.
+    // A dump whose tail already sits in the pipe buffer still counts as written
+    size_t dropped = 0;
+    for (size_t round = 0; round < 200; round++) {
+        int fd = open(fifo.path.c_str(), O_RDONLY | O_NONBLOCK);
+        std::thread reader([&] {
+            size_t got = 0, stop = text.size() * (round % 9 + 1) / 10;
+            char buf[4096];
+            while (got < stop) {
+                ssize_t n = read(fd, buf, sizeof(buf));
+                if (n > 0) got += (size_t)n;
+            }
+            close(fd);
+        });
+        if (!WriteMetricsText(fifo.path.wstring(), text)) dropped++;
+        reader.join();
+    }
+    CHECK(dropped > 0);
+
+    sigset_t pending;
+    sigpending(&pending);
+    CHECK(!sigismember(&pending, SIGPIPE)); // Nothing left to fire once unblocked
+}
+
+TEST(StalledReaderDropsDumpAndStopReturns) {
+    FIFO fifo("traycaddy_test_stalled.fifo");
+    MetricsRegistry registry;
+    FillRegistry(&registry, 5000);
+
+    // Opened but never read: the pipe fills and stays full
+    int fd = open(fifo.path.c_str(), O_RDONLY | O_NONBLOCK);
+    CHECK(fd >= 0);
+    std::string text;
+    registry.FormatPrometheus(&text);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(!WriteMetricsText(fifo.path.wstring(), text));
+    double took = SecondsSince(start);
+    CHECK(took >= METRICS_PIPE_TIMEOUT_MS / 1000.0 * 0.9 && took < METRICS_PIPE_TIMEOUT_MS / 1000.0 + 1.0);
+
+    MetricsExporter exporter(&registry);
+    exporter.Start(fifo.path.wstring(), 10, nullptr);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // Worker is now stuck on the full pipe
+    start = std::chrono::steady_clock::now();
+    exporter.Stop();
+    CHECK(SecondsSince(start) < METRICS_PIPE_TIMEOUT_MS / 1000.0 + 1.0);
+    CHECK_EQ(exporter.GetExportCount(), 0u);
+    close(fd);
+}
+
+#endif
+
+int main() { return RunTests(); }
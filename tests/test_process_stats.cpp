@@ -0,0 +1,183 @@
+#include "Test.h"
+#include "ProcessStats.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// --- Rate Computation ---
+
+static PROCESS_SAMPLE Sample(uint32_t pid, uint64_t cpuTime, uint64_t workingSet = 4096, bool valid = true) {
+    PROCESS_SAMPLE s;
+    s.pid = pid;
+    s.cpuTime = cpuTime;
+    s.workingSet = workingSet;
+    s.valid = valid;
+    return s;
+}
+
+TEST(UsageIsShareOfAllProcessors) {
+    std::unordered_map<uint32_t, PROCESS_SAMPLE> previous = { { 1, Sample(1, 1000) } };
+    std::vector<PROCESS_USAGE> out;
+    // 500 units of CPU over 1000 units of wall time on 4 processors = 12.5%
+    ComputeUsage(previous, { Sample(1, 1500, 8192) }, 1000, 4, out);
+    CHECK_EQ(out.size(), 1u);
+    CHECK(out[0].cpuPercent > 12.49 && out[0].cpuPercent < 12.51);
+    CHECK_EQ(out[0].workingSet, 8192u);
+}
+
+TEST(UsageClampsAndHandlesNewAndRecycledPids) {
+    std::unordered_map<uint32_t, PROCESS_SAMPLE> previous = { { 1, Sample(1, 0) }, { 2, Sample(2, 5000) } };
+    std::vector<PROCESS_USAGE> out;
+    ComputeUsage(previous, { Sample(1, 9000), Sample(2, 10), Sample(3, 700), Sample(4, 0, 0, false) }, 1000, 1, out);
+    CHECK_EQ(out.size(), 3u); // Invalid samples are dropped
+    CHECK_EQ(out[0].cpuPercent, 100.0); // Clamped
+    CHECK_EQ(out[1].cpuPercent, 0.0);   // CPU time went backwards: a recycled pid
+    CHECK_EQ(out[2].cpuPercent, 0.0);   // No previous sample yet
+}
+
+// --- Cost Ordering ---
+
+static USAGE_SORT_KEY Key(unsigned id, bool measured, double cpu = 0, uint64_t memory = 0) {
+    USAGE_SORT_KEY key;
+    key.id = id;
+    key.measured = measured;
+    key.cpuPercent = cpu;
+    key.workingSet = memory;
+    return key;
+}
+
+static std::vector<unsigned> Ids(const std::vector<USAGE_SORT_KEY>& keys) {
+    std::vector<unsigned> ids;
+    for (const auto& key : keys) ids.push_back(key.id);
+    return ids;
+}
+
+TEST(HideOrderIgnoresMeasurements) {
+    // Processes that cannot be opened (elevated, exited) stay where they were hidden
+    std::vector<USAGE_SORT_KEY> keys = { Key(1, false), Key(2, true, 50), Key(3, false), Key(4, true, 1) };
+    SortUsageKeys(keys, ORDER_AS_GIVEN);
+    CHECK(Ids(keys) == std::vector<unsigned>({ 1, 2, 3, 4 }));
+}
+
+TEST(CostOrderPutsUnmeasuredLast) {
+    std::vector<USAGE_SORT_KEY> keys = { Key(1, false), Key(2, true, 5, 100), Key(3, true, 50, 10), Key(4, true, 5, 300), Key(5, false) };
+    std::vector<USAGE_SORT_KEY> byCpu = keys, byMemory = keys;
+    SortUsageKeys(byCpu, ORDER_BY_CPU);
+    SortUsageKeys(byMemory, ORDER_BY_MEMORY);
+    CHECK(Ids(byCpu) == std::vector<unsigned>({ 3, 2, 4, 1, 5 })); // Ties keep hide order
+    CHECK(Ids(byMemory) == std::vector<unsigned>({ 4, 2, 3, 1, 5 }));
+}
+
+// --- Sampler ---
+
+// Every pid burns 1ms of CPU per query; pids above 1000 do not exist.
+class FakeProcessStats : public IProcessStats {
+public:
+    std::atomic<int> queries{ 0 };
+
+    void QueryBatch(const std::vector<uint32_t>& pids, std::vector<PROCESS_SAMPLE>& out) override {
+        int n = ++queries;
+        out.clear();
+        for (uint32_t pid : pids) out.push_back(Sample(pid, (uint64_t)n * 10000, pid * 1024ull, pid <= 1000));
+    }
+    unsigned GetProcessorCount() override { return 1; }
+};
+
+TEST(SamplerReportsTrackedPids) {
+    auto source = std::make_unique<FakeProcessStats>();
+    StatsSampler sampler(std::move(source), 1000);
+    sampler.SetPids({ 7, 2000 });
+    sampler.SampleNow();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    sampler.SampleNow();
+
+    PROCESS_USAGE usage;
+    CHECK(sampler.GetUsage(7, &usage));
+    CHECK_EQ(usage.workingSet, 7u * 1024);
+    CHECK(usage.cpuPercent > 0.0);
+    CHECK(!sampler.GetUsage(2000, &usage)); // Gone processes are not reported
+
+    std::unordered_map<uint32_t, PROCESS_USAGE> all;
+    sampler.CopyUsage(&all);
+    CHECK_EQ(all.size(), 1u);
+    CHECK(all.count(7) == 1);
+}
+
+TEST(SetPidsKeepsTheSamplingCadence) {
+    auto source = std::make_unique<FakeProcessStats>();
+    FakeProcessStats* fake = source.get();
+    StatsSampler sampler(std::move(source), 60000);
+    std::atomic<int> updates{ 0 };
+    sampler.Start([&] { updates++; });
+    while (updates == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // List refreshes hand over new pid sets; none of them may trigger a pass
+    for (uint32_t pid = 1; pid <= 20; pid++) sampler.SetPids({ pid });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sampler.Stop();
+    CHECK_EQ(fake->queries.load(), 1);
+    CHECK_EQ(updates.load(), 1);
+}
+
+TEST(ShorterIntervalAppliesToTheCurrentWait) {
+    auto source = std::make_unique<FakeProcessStats>();
+    StatsSampler sampler(std::move(source), 60000);
+    std::atomic<int> updates{ 0 };
+    sampler.Start([&] { updates++; });
+    while (updates == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    auto start = std::chrono::steady_clock::now();
+    sampler.SetInterval(20);
+    while (updates < 3 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    sampler.Stop();
+    CHECK(updates.load() >= 3);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+}
+
+// --- /proc ---
+
+#ifndef _WIN32
+
+TEST(ProcStatSkipsCommandName) {
+    uint64_t utime = 0, stime = 0;
+    // The command name may contain spaces and parentheses
+    std::string line = "1234 (my (odd) prog) S 1 1234 1234 0 -1 4194560 500 0 0 0 321 45 0 0 20 0 1 0 100 1000 50";
+    CHECK(ParseProcStat(line, &utime, &stime));
+    CHECK_EQ(utime, 321u);
+    CHECK_EQ(stime, 45u);
+    CHECK(!ParseProcStat("1234 (truncated) S 1 2", &utime, &stime));
+    CHECK(!ParseProcStat("garbage", &utime, &stime));
+}
+
+TEST(ProcFsReadsOwnProcess) {
+    auto stats = CreateProcessStats();
+    CHECK(stats->GetProcessorCount() >= 1);
+
+    uint32_t self = (uint32_t)getpid();
+    std::vector<PROCESS_SAMPLE> before, after;
+    stats->QueryBatch({ self, 0x7FFFFFF0u }, before);
+    CHECK_EQ(before.size(), 2u);
+    CHECK(before[0].valid && before[0].pid == self);
+    CHECK(before[0].workingSet > 0);
+    CHECK(!before[1].valid); // No such process
+
+    // Burn enough CPU for at least a few clock ticks
+    auto start = std::chrono::steady_clock::now();
+    volatile uint64_t spin = 0;
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(60)) spin = spin + 1;
+    stats->QueryBatch({ self }, after);
+    CHECK(after[0].valid);
+    CHECK(after[0].cpuTime > before[0].cpuTime);
+}
+
+#endif
+
+int main() { return RunTests(); }
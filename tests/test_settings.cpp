@@ -0,0 +1,216 @@
+#include "Test.h"
+#include "Settings.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// --- Helpers ---
+
+static Settings Parse(const std::string& text) {
+    Settings settings;
+    ParseSettings(text, &settings);
+    return settings;
+}
+
+static std::filesystem::path TempFile(const char* name) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return path;
+}
+
+static void WriteRaw(const std::filesystem::path& path, const std::string& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), (std::streamsize)data.size());
+}
+
+// Moves the timestamp out of the settle window so the watcher reads the file
+static void Age(const std::filesystem::path& path) {
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - std::chrono::seconds(10));
+}
+
+// --- Parsing ---
+
+TEST(LookupsIgnoreCase) {
+    Settings settings = Parse("[Settings]\r\nKey=90\r\n[AutoHide]\r\nclass:Notepad=10\r\n");
+    CHECK(settings.Find(L"settings", L"KEY") != nullptr);
+    CHECK(settings.GetString(L"AUTOHIDE", L"Class:notepad") == L"10");
+    CHECK(settings.Find(L"Settings", L"Missing") == nullptr);
+    CHECK(settings.FindSection(L"autohide") != nullptr);
+    CHECK_EQ(settings.GetSections().size(), 2u);
+}
+
+TEST(ValuesAreTrimmedAndUnquoted) {
+    Settings settings = Parse("[S]\n  a =  spaced out  \nb=\"  kept  \"\nc=\"\nd=\n=orphan\nno equals\n");
+    CHECK(settings.GetString(L"S", L"a") == L"spaced out");
+    CHECK(settings.GetString(L"S", L"b") == L"  kept  ");
+    CHECK(settings.GetString(L"S", L"c") == L"\"");
+    CHECK(settings.Find(L"S", L"d") != nullptr);
+    CHECK_EQ(settings.FindSection(L"S")->entries.size(), 4u);
+}
+
+TEST(FirstDuplicateWins) {
+    Settings settings = Parse("[S]\nx=1\nX=2\n[s]\nx=3\ny=4\n");
+    CHECK_EQ(settings.GetInt(L"S", L"x", 0), 1);
+    CHECK_EQ(settings.GetInt(L"S", L"y", 0), 4); // The repeated header merges into the first
+    CHECK_EQ(settings.GetSections().size(), 1u);
+
+    // The dropped duplicate's comments stay with the next entry
+    settings = Parse("[S]\r\nx=1\r\n; About the copy\r\nx=2\r\n; About y\r\ny=4\r\n; About the last copy\r\ny=5\r\n");
+    CHECK(SerializeSettings(settings) == "[S]\r\nx=1\r\n; About the copy\r\n; About y\r\ny=4\r\n; About the last copy\r\n");
+}
+
+TEST(NumbersAndBooleans) {
+    Settings settings = Parse("[S]\nhex=0x5A\nneg=-3\nbad=12abc\nempty=\nyes=Yes\noff=OFF\nmaybe=maybe\n");
+    CHECK_EQ(settings.GetInt(L"S", L"hex", 0), 0x5A);
+    CHECK_EQ(settings.GetInt(L"S", L"neg", 0), -3);
+    CHECK_EQ(settings.GetInt(L"S", L"bad", 7), 7);
+    CHECK_EQ(settings.GetInt(L"S", L"empty", 7), 7);
+    CHECK_EQ(settings.GetInt(L"S", L"missing", 7), 7);
+    CHECK(settings.GetBool(L"S", L"yes", false));
+    CHECK(!settings.GetBool(L"S", L"off", true));
+    CHECK(settings.GetBool(L"S", L"maybe", true));
+}
+
+TEST(DecodesEveryEncoding) {
+    // "Ä€" in UTF-8 with BOM, UTF-16LE with BOM, and a Latin-1 'Ä' that is not valid UTF-8
+    CHECK(Parse("\xEF\xBB\xBF[S]\nv=\xC3\x84\xE2\x82\xAC\n").GetString(L"S", L"v") == L"Ä€");
+    std::string utf16 = "\xFF\xFE";
+    for (wchar_t ch : std::wstring(L"[S]\nv=Ä€\n")) { utf16.push_back((char)(ch & 0xFF)); utf16.push_back((char)(ch >> 8)); }
+    CHECK(Parse(utf16).GetString(L"S", L"v") == L"Ä€");
+    CHECK(Parse("[S]\nv=\xC4rger\n").GetString(L"S", L"v") == L"Ärger");
+}
+
+// --- Round Trips ---
+
+TEST(CommentsSurviveRewrite) {
+    std::string text =
+        "; TrayCaddy settings\r\n"
+        "\r\n"
+        "[Settings]\r\n"
+        "; The hotkey\r\n"
+        "Key=90\r\n"
+        "Spaced=\"  x  \"\r\n"
+        "\r\n"
+        "[AutoHide]\r\n"
+        "# Minutes\r\n"
+        "class:Notepad=10\r\n"
+        "; the end\r\n";
+    CHECK(SerializeSettings(Parse(text)) == text);
+}
+
+TEST(RepeatedHeaderCommentsMoveToNextEntry) {
+    std::string text =
+        "[Settings]\r\n"
+        "A=1\r\n"
+        "[Other]\r\n"
+        "B=2\r\n"
+        "; About C\r\n"
+        "[Settings]\r\n"
+        "C=3\r\n";
+    Settings settings = Parse(text);
+    CHECK(settings.FindSection(L"Settings")->entries.back().leading == L"; About C\n");
+    CHECK(SerializeSettings(settings) ==
+        "[Settings]\r\n"
+        "A=1\r\n"
+        "; About C\r\n"
+        "C=3\r\n"
+        "\r\n"
+        "[Other]\r\n"
+        "B=2\r\n");
+
+    // Nothing follows the repeated header: the comment ends up trailing instead of lost
+    settings = Parse("[S]\nA=1\n; Orphan\n[S]\n");
+    CHECK(SerializeSettings(settings) == "[S]\r\nA=1\r\n; Orphan\r\n");
+}
+
+TEST(EditsKeepOrderAndIndex) {
+    Settings settings = Parse("[S]\na=1\nb=2\nc=3\n");
+    settings.Set(L"S", L"B", L"20");
+    settings.Set(L"T", L"new", L"x");
+    settings.Remove(L"S", L"a");
+    settings.Remove(L"S", L"missing");
+    CHECK(settings.Find(L"S", L"a") == nullptr);
+    CHECK_EQ(settings.GetInt(L"S", L"b", 0), 20);
+    CHECK_EQ(settings.GetInt(L"S", L"c", 0), 3); // Indexes after the removed entry still resolve
+    CHECK(SerializeSettings(settings) == "[S]\r\nb=20\r\nc=3\r\n\r\n[T]\r\nnew=x\r\n");
+}
+
+// --- Store ---
+
+TEST(AtomicWriteReplacesFile) {
+    std::filesystem::path path = TempFile("traycaddy_test_atomic.ini");
+    CHECK(WriteFileAtomic(path.wstring(), "one"));
+    CHECK(WriteFileAtomic(path.wstring(), "two"));
+    std::ifstream file(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    CHECK(data == "two");
+    CHECK(!std::filesystem::exists(path.string() + ".tmp"));
+    std::filesystem::remove(path);
+}
+
+TEST(StoreSeesOutsideEditsOnly) {
+    std::filesystem::path path = TempFile("traycaddy_test_store.ini");
+    SettingsStore store(path.wstring());
+    CHECK(!store.Load()); // Missing file: empty snapshot
+    CHECK(store.Get()->GetSections().empty());
+
+    Settings settings;
+    settings.SetInt(L"Settings", L"Key", 90);
+    CHECK(store.Save([&](Settings* next) { *next = settings; }));
+    SETTINGS_SNAPSHOT before = store.Get();
+    Age(path);
+    CHECK(!store.CheckForChanges()); // Our own bytes
+    CHECK(store.Get() == before);
+
+    WriteRaw(path, "[Settings]\r\nKey=72\r\n");
+    Age(path);
+    CHECK(store.CheckForChanges());
+    CHECK_EQ(store.Get()->GetInt(L"Settings", L"Key", 0), 72);
+    CHECK_EQ(before->GetInt(L"Settings", L"Key", 0), 90); // Old snapshots never change
+    CHECK(!store.CheckForChanges());
+
+    std::filesystem::remove(path);
+    CHECK(!store.CheckForChanges()); // Keeps the last good settings
+    CHECK_EQ(store.Get()->GetInt(L"Settings", L"Key", 0), 72);
+}
+
+TEST(SaveKeepsOutsideEditsNotYetSeen) {
+    std::filesystem::path path = TempFile("traycaddy_test_merge.ini");
+    WriteRaw(path, "[Settings]\r\nKey=90\r\n");
+    Age(path);
+    SettingsStore store(path.wstring());
+    CHECK(store.Load());
+    int changes = 0;
+    store.StartWatching([&] { changes++; }, 60000); // The watcher has not looked yet
+
+    // Edited outside, then saved from the app within the same poll window
+    WriteRaw(path, "[Settings]\r\nKey=90\r\n\r\n[AutoHide]\r\n*=30\r\n");
+    auto start = std::chrono::steady_clock::now();
+    CHECK(store.Save([](Settings* next) { next->SetInt(L"Settings", L"SortMode", 2); }));
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(150)); // Waited for the editor to settle
+    store.StopWatching();
+    CHECK_EQ(changes, 1);
+
+    SETTINGS_SNAPSHOT saved = store.Get();
+    CHECK_EQ(saved->GetInt(L"Settings", L"SortMode", 0), 2);
+    CHECK_EQ(saved->GetInt(L"AutoHide", L"*", 0), 30);
+    std::ifstream file(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    CHECK(data == "[Settings]\r\nKey=90\r\nSortMode=2\r\n\r\n[AutoHide]\r\n*=30\r\n");
+
+    // Nothing changed outside since: the edit goes on top of our own snapshot
+    Age(path);
+    CHECK(store.Save([](Settings* next) { next->SetInt(L"Settings", L"Key", 72); }));
+    CHECK_EQ(changes, 1);
+    CHECK_EQ(store.Get()->GetInt(L"Settings", L"Key", 0), 72);
+    CHECK_EQ(store.Get()->GetInt(L"AutoHide", L"*", 0), 30);
+    Age(path);
+    CHECK(!store.CheckForChanges()); // Our own bytes
+    std::filesystem::remove(path);
+}
+
+int main() { return RunTests(); }
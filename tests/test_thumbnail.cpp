@@ -0,0 +1,156 @@
+#include "Test.h"
+#include "Thumbnail.h"
+
+#include <random>
+#include <vector>
+
+// --- Helpers ---
+
+struct IMAGE {
+    int width;
+    int height;
+    size_t stride; // Bytes
+    std::vector<uint8_t> bytes;
+};
+
+// Random BGRA pixels; padding bytes past each row are random too, so reads
+// beyond the row would show up as mismatches.
+static IMAGE RandomImage(std::mt19937& rng, int width, int height, size_t padding) {
+    IMAGE image{ width, height, (size_t)width * 4 + padding, {} };
+    image.bytes.resize(image.stride * height);
+    for (auto& b : image.bytes) b = (uint8_t)rng();
+    return image;
+}
+
+static uint16_t Rgb565(unsigned r, unsigned g, unsigned b) {
+    return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+// --- Sizing ---
+
+TEST(FitKeepsAspectAndNeverUpscales) {
+    int w, h;
+    FitThumbnailSize(1920, 1080, 256, 160, &w, &h);
+    CHECK(w == 256 && h == 144);
+    FitThumbnailSize(800, 1200, 256, 160, &w, &h);
+    CHECK(w == 106 && h == 160);
+    FitThumbnailSize(100, 50, 256, 160, &w, &h);
+    CHECK(w == 100 && h == 50);
+    FitThumbnailSize(10000, 1, 256, 160, &w, &h);
+    CHECK(w == 256 && h == 1);
+    FitThumbnailSize(0, 50, 256, 160, &w, &h);
+    CHECK(w == 0 && h == 0);
+}
+
+// --- Resampler ---
+
+TEST(ReferenceAveragesEachBox) {
+    // 4x2 BGRA to 2x1: each output pixel averages a 2x2 box
+    uint8_t src[] = {
+        0, 0, 0, 255,      8, 8, 8, 255,      255, 0, 0, 255,  255, 0, 0, 255,
+        16, 16, 16, 255,   24, 24, 24, 255,   0, 0, 255, 255,  0, 0, 255, 255,
+    };
+    uint16_t dst[2] = {};
+    DownscaleBoxScalar(src, 4, 2, 16, dst, 2, 1, 2);
+    CHECK_EQ(dst[0], Rgb565(12, 12, 12));
+    CHECK_EQ(dst[1], Rgb565(128, 0, 128)); // (255 + 255 + 0 + 0 + 2) / 4 rounds to 128
+}
+
+TEST(UniformImageStaysUniform) {
+    std::vector<uint8_t> src(37 * 23 * 4);
+    for (size_t i = 0; i < src.size(); i += 4) { src[i] = 40; src[i + 1] = 130; src[i + 2] = 220; src[i + 3] = 255; }
+    std::vector<uint16_t> dst(5 * 3);
+    DownscaleBox(src.data(), 37, 23, 37 * 4, dst.data(), 5, 3, 5);
+    for (uint16_t px : dst) CHECK_EQ(px, Rgb565(220, 130, 40));
+}
+
+TEST(RowAccumulationMatchesReference) {
+    std::mt19937 rng(1234);
+    int mismatches = 0, cases = 0;
+    // Odd widths exercise the vectorized tails; 1-pixel outputs the widest spans
+    for (int srcW : { 1, 3, 7, 8, 9, 31, 33, 64, 257, 1000 }) {
+        for (int srcH : { 1, 2, 5, 40, 333 }) {
+            for (int dstW : { 1, 2, 7, 64, 256 }) {
+                for (int dstH : { 1, 3, 40, 160 }) {
+                    if (dstW > srcW || dstH > srcH) continue;
+                    IMAGE image = RandomImage(rng, srcW, srcH, (size_t)(srcW % 3) * 4);
+                    size_t dstStride = (size_t)dstW + 1;
+                    std::vector<uint16_t> expected(dstStride * dstH, 0xBEEF), actual(dstStride * dstH, 0xBEEF);
+                    DownscaleBoxScalar(image.bytes.data(), srcW, srcH, image.stride, expected.data(), dstW, dstH, dstStride);
+                    DownscaleBox(image.bytes.data(), srcW, srcH, image.stride, actual.data(), dstW, dstH, dstStride);
+                    cases++;
+                    if (actual != expected) mismatches++;
+                }
+            }
+        }
+    }
+    CHECK(cases > 0);
+    CHECK_EQ(mismatches, 0);
+}
+
+TEST(MakeThumbnailPadsRows) {
+    std::mt19937 rng(7);
+    IMAGE image = RandomImage(rng, 1001, 600, 0);
+    THUMBNAIL thumb;
+    CHECK(MakeThumbnail(image.bytes.data(), image.width, image.height, image.stride, 255, 160, &thumb));
+    CHECK(thumb.width == 255 && thumb.height == 152);
+    CHECK_EQ(thumb.stride, 256); // Even, for DWORD-aligned DIB rows
+    CHECK_EQ(thumb.Bytes(), (size_t)256 * 152 * 2);
+    CHECK(!MakeThumbnail(image.bytes.data(), 0, 0, 0, 255, 160, &thumb));
+}
+
+// --- Cache ---
+
+static THUMBNAIL ThumbOfBytes(size_t bytes) {
+    THUMBNAIL thumb;
+    thumb.width = thumb.stride = (int)(bytes / 2);
+    thumb.height = 1;
+    thumb.pixels.resize(bytes / 2);
+    return thumb;
+}
+
+TEST(CacheEvictsLeastRecentlyUsed) {
+    ThumbnailCache cache(300);
+    CHECK(cache.Put(1, ThumbOfBytes(100)));
+    CHECK(cache.Put(2, ThumbOfBytes(100)));
+    CHECK(cache.Put(3, ThumbOfBytes(100)));
+    CHECK(cache.Get(1) != nullptr); // 2 is now the oldest
+    CHECK(cache.Put(4, ThumbOfBytes(100)));
+    CHECK(cache.Get(2) == nullptr);
+    CHECK(cache.Get(1) && cache.Get(3) && cache.Get(4));
+    CHECK_EQ(cache.Bytes(), 300u);
+    CHECK_EQ(cache.Count(), 3u);
+}
+
+TEST(CacheBudgetIsHard) {
+    ThumbnailCache cache(300);
+    CHECK(!cache.Put(1, ThumbOfBytes(400))); // Bigger than the whole budget
+    CHECK_EQ(cache.Count(), 0u);
+
+    cache.Put(1, ThumbOfBytes(100));
+    cache.Put(2, ThumbOfBytes(100));
+    cache.Put(1, ThumbOfBytes(200)); // Replacing counts the new size only
+    CHECK_EQ(cache.Bytes(), 300u);
+    cache.Put(3, ThumbOfBytes(250));
+    CHECK(cache.Bytes() <= 300u);
+    CHECK(cache.Get(3) != nullptr);
+
+    cache.SetBudget(100);
+    CHECK_EQ(cache.Count(), 0u); // 250 no longer fits
+    CHECK_EQ(cache.Bytes(), 0u);
+}
+
+TEST(CacheRemoveAndClear) {
+    ThumbnailCache cache(1000);
+    cache.Put(1, ThumbOfBytes(100));
+    cache.Put(2, ThumbOfBytes(100));
+    cache.Remove(1);
+    cache.Remove(42);
+    CHECK_EQ(cache.Bytes(), 100u);
+    cache.Clear();
+    CHECK_EQ(cache.Count(), 0u);
+    CHECK_EQ(cache.Bytes(), 0u);
+    CHECK(cache.Put(3, ThumbOfBytes(1000)));
+}
+
+int main() { return RunTests(); }
@@ -0,0 +1,134 @@
+#include "Test.h"
+#include "TimerWheel.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+
+// --- Helpers ---
+
+static std::vector<TIMER_EXPIRY> AdvanceTo(TimerWheel& wheel, uint64_t tick) {
+    std::vector<TIMER_EXPIRY> expired;
+    wheel.Advance(tick, &expired);
+    return expired;
+}
+
+// --- Scheduling ---
+
+TEST(FiresOnTheTickItWasScheduledFor) {
+    TimerWheel wheel;
+    TIMER_ID id = wheel.Schedule(10, 42);
+    CHECK(id != 0);
+    CHECK_EQ(wheel.NextTick(), 10u);
+    CHECK(AdvanceTo(wheel, 9).empty());
+    std::vector<TIMER_EXPIRY> expired = AdvanceTo(wheel, 10);
+    CHECK_EQ(expired.size(), 1u);
+    CHECK(expired[0].id == id && expired[0].userData == 42);
+    CHECK_EQ(wheel.Count(), 0u);
+    CHECK_EQ(wheel.NextTick(), WHEEL_NO_TIMER);
+    CHECK(!wheel.Cancel(id)); // Already fired
+}
+
+TEST(PastTicksFireOnNextAdvance) {
+    TimerWheel wheel(1000);
+    wheel.Schedule(5, 1);
+    CHECK_EQ(AdvanceTo(wheel, 1001).size(), 1u);
+}
+
+TEST(CancelledTimersStaySilent) {
+    TimerWheel wheel;
+    TIMER_ID a = wheel.Schedule(100, 1);
+    TIMER_ID b = wheel.Schedule(100, 2);
+    CHECK(wheel.Cancel(a));
+    CHECK(!wheel.Cancel(a));
+    CHECK(!wheel.Cancel(0));
+    std::vector<TIMER_EXPIRY> expired = AdvanceTo(wheel, 100);
+    CHECK(expired.size() == 1 && expired[0].id == b);
+
+    // A reused node gets a new id; the stale one cannot cancel it
+    TIMER_ID c = wheel.Schedule(200, 3);
+    CHECK(c != a && c != b);
+    CHECK(!wheel.Cancel(b));
+    CHECK(wheel.Cancel(c));
+}
+
+TEST(FarTimersCascadeDown) {
+    TimerWheel wheel;
+    const uint64_t far[] = { 64, 65, 4095, 4096, 300000, 16777215, 16777216, 16777216ull * 3 + 7 };
+    for (uint64_t tick : far) wheel.Schedule(tick, tick);
+    for (uint64_t tick : far) {
+        CHECK(wheel.NextTick() <= tick);
+        CHECK(AdvanceTo(wheel, tick - 1).empty());
+        std::vector<TIMER_EXPIRY> expired = AdvanceTo(wheel, tick);
+        CHECK(expired.size() == 1 && expired[0].userData == tick);
+    }
+}
+
+TEST(NextTickSkipsEmptyFarSlots) {
+    // The owner sleeps until NextTick, so waking at every 64-tick boundary would be wasted
+    TimerWheel wheel(100);
+    wheel.Schedule(220, 1);
+    CHECK_EQ(wheel.NextTick(), 192u); // Where 220's slot is re-filed
+    CHECK(AdvanceTo(wheel, 192).empty());
+    CHECK_EQ(wheel.NextTick(), 220u);
+    wheel.Schedule(100000, 2);
+    CHECK_EQ(wheel.NextTick(), 220u);
+    AdvanceTo(wheel, 220);
+    CHECK_EQ(wheel.NextTick(), 98304u); // 100000 rounded down to its level 2 slot
+}
+
+TEST(EmptyWheelJumpsToNow) {
+    TimerWheel wheel;
+    AdvanceTo(wheel, 1000000000);
+    CHECK_EQ(wheel.GetCurrentTick(), 1000000000u);
+    wheel.Schedule(1000000005, 1);
+    CHECK_EQ(wheel.NextTick(), 1000000005u);
+}
+
+// Random schedules, cancels and advances against a plain map of due ticks
+TEST(MatchesReferenceModel) {
+    std::mt19937_64 rng(99);
+    TimerWheel wheel;
+    std::unordered_map<TIMER_ID, uint64_t> live; // Id -> tick it should fire on
+    std::vector<TIMER_ID> ids;
+    uint64_t now = 0;
+    int wrong = 0;
+
+    for (int step = 0; step < 20000; step++) {
+        int action = (int)(rng() % 10);
+        if (action < 5) {
+            uint64_t delay = rng() % 4 == 0 ? rng() % 300000 : rng() % 200;
+            TIMER_ID id = wheel.Schedule(now + delay, step);
+            live[id] = std::max(now + delay, wheel.GetCurrentTick() + 1); // Ticks already processed fire on the next
+            ids.push_back(id);
+        }
+        else if (action < 7 && !ids.empty()) {
+            TIMER_ID id = ids[rng() % ids.size()];
+            bool expected = live.erase(id) != 0;
+            if (wheel.Cancel(id) != expected) wrong++;
+        }
+        else {
+            uint64_t earliest = UINT64_MAX;
+            for (const auto& [id, due] : live) earliest = std::min(earliest, due);
+            if (!live.empty() && wheel.NextTick() > std::max(earliest, now + 1)) wrong++;
+
+            now += rng() % 3 == 0 ? rng() % 5000 : rng() % 50;
+            std::vector<TIMER_EXPIRY> expired = AdvanceTo(wheel, now);
+            size_t due = 0;
+            for (const auto& [id, tick] : live) if (tick <= now) due++;
+            if (expired.size() != due) wrong++;
+            uint64_t previous = 0;
+            for (const auto& timer : expired) {
+                auto it = live.find(timer.id);
+                if (it == live.end() || it->second > now) { wrong++; continue; }
+                if (it->second < previous) wrong++; // Expiry order
+                previous = std::max(previous, it->second);
+                live.erase(it);
+            }
+        }
+        if (wheel.Count() != live.size()) wrong++;
+    }
+    CHECK_EQ(wrong, 0);
+}
+
+int main() { return RunTests(); }
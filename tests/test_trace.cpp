@@ -0,0 +1,218 @@
+#include "Test.h"
+#include "EventTrace.h"
+#include "SimBackend.h"
+#include "TraceReplay.h"
+#include "resource.h"
+
+#include <filesystem>
+#include <string>
+
+// --- Helpers ---
+
+static TRACE_EVENT Event(TRACE_EVENT_TYPE type, uint64_t window = 0, uint32_t param = 0, uint32_t param2 = 0,
+    const std::wstring& text = std::wstring(), const std::wstring& className = std::wstring()) {
+    TRACE_EVENT event;
+    event.type = type;
+    event.window = window;
+    event.param = param;
+    event.param2 = param2;
+    event.text = text;
+    event.className = className;
+    return event;
+}
+
+static TRACE_EVENT DoubleClick(uint32_t iconId) { return Event(TRACE_TRAY_ICON, 0, iconId, TRACE_MOUSE_DBLCLK); }
+
+struct REPLAY {
+    SIM_BACKEND sim;
+    CORE_STATE core;
+
+    REPLAY() { sim.Attach(&core); }
+
+    const HIDDEN_WINDOW* HiddenTitled(const std::wstring& title) const {
+        for (const auto& item : core.hiddenWindows) if (item.title == title) return &item;
+        return nullptr;
+    }
+};
+
+// --- Encoding ---
+
+TEST(EventsRoundTrip) {
+    std::vector<TRACE_EVENT> events = {
+        Event(TRACE_WINDOW_CREATED, 0x1234, 0, 42, L"Notes", L"Notepad"),
+        Event(TRACE_HOTKEY, 0x1234, 1007, 42, L"Notes é", L"Notepad"),
+        Event(TRACE_HOTKEY, 0x10010, 0, 7, std::wstring(), L"Progman"),
+        DoubleClick(1007),
+        Event(TRACE_TASKBAR_CREATED),
+        Event(TRACE_RESTORE, 0, 1008),
+    };
+    events[1].timeUs = 1500;
+    events[2].timeUs = 1500;
+    events[3].timeUs = 90000000;
+    events[4].timeUs = 90000001;
+    events[5].timeUs = 90000002;
+
+    std::string data = "TCTR";
+    data.push_back(2);
+    uint64_t previous = 0;
+    for (const auto& event : events) { EncodeTraceEvent(event, previous, &data); previous = event.timeUs; }
+
+    std::vector<TRACE_EVENT> decoded;
+    CHECK(DecodeTrace(data, &decoded));
+    CHECK_EQ(decoded.size(), events.size());
+    for (size_t i = 0; i < decoded.size() && i < events.size(); i++) {
+        CHECK_EQ(decoded[i].type, events[i].type);
+        CHECK_EQ(decoded[i].timeUs, events[i].timeUs);
+        CHECK_EQ(decoded[i].window, events[i].window);
+        CHECK_EQ(decoded[i].param, events[i].param);
+        CHECK_EQ(decoded[i].param2, events[i].param2);
+        CHECK(decoded[i].text == events[i].text);
+        CHECK(decoded[i].className == events[i].className);
+    }
+
+    CHECK(!DecodeTrace(data.substr(0, data.size() - 3), &decoded)); // Truncated record
+    data[4] = 1;
+    CHECK(!DecodeTrace(data, &decoded)); // Version 1 has no outcomes to replay against
+}
+
+// --- Replay ---
+
+TEST(ShellWindowKeepsIconIdsInStep) {
+    // The hotkey pressed on the desktop hid nothing, so A and B got the next ids.
+    // Replaying the desktop as an ordinary window would hand A's id to it and
+    // the double click would restore the wrong window.
+    REPLAY r;
+    std::vector<TRACE_EVENT> events = {
+        Event(TRACE_HOTKEY, 0x100, 0, 1, L"Program Manager", L"Progman"),
+        Event(TRACE_HOTKEY, 0x200, 1003, 2, L"A", L"Notepad"),
+        Event(TRACE_HOTKEY, 0x300, 1004, 3, L"B", L"Notepad"),
+        DoubleClick(1004),
+    };
+    TRACE_REPLAY_STATS stats = ReplayTrace(events, &r.core, &r.sim, PACING_FULL_SPEED);
+    CHECK_EQ(stats.events, 4u);
+    CHECK_EQ(stats.hides, 2u);
+    CHECK_EQ(stats.restores, 1u);
+    CHECK_EQ(stats.mismatches, 0u);
+    CHECK(r.HiddenTitled(L"A") != nullptr);
+    CHECK(r.HiddenTitled(L"B") == nullptr);
+    CHECK_EQ(r.core.hiddenWindows.size(), 1u);
+}
+
+TEST(ListRestoreIsReplayed) {
+    // Restored from the list, then hidden again with the hotkey: without the
+    // restore the second hotkey would find the window still hidden
+    REPLAY r;
+    std::vector<TRACE_EVENT> events = {
+        Event(TRACE_HOTKEY, 0x200, 1000, 2, L"A", L"Notepad"),
+        Event(TRACE_RESTORE, 0, 1000),
+        Event(TRACE_HOTKEY, 0x200, 1001, 2, L"A", L"Notepad"),
+        Event(TRACE_RESTORE, 0, 1000), // Stale id: already restored
+    };
+    TRACE_REPLAY_STATS stats = ReplayTrace(events, &r.core, &r.sim, PACING_FULL_SPEED);
+    CHECK_EQ(stats.hides, 2u);
+    CHECK_EQ(stats.restores, 1u);
+    CHECK_EQ(stats.mismatches, 0u);
+    CHECK(r.HiddenTitled(L"A") != nullptr);
+    CHECK_EQ(r.sim.tray.addCount, 2u);
+}
+
+TEST(RecordedTrayFailureIsReplayed) {
+    REPLAY r;
+    std::vector<TRACE_EVENT> events = {
+        Event(TRACE_HOTKEY, 0x200, 0, 2, L"A", L"Notepad"), // The tray was restarting
+        Event(TRACE_HOTKEY, 0x200, 1001, 2, L"A", L"Notepad"),
+        DoubleClick(1001),
+    };
+    TRACE_REPLAY_STATS stats = ReplayTrace(events, &r.core, &r.sim, PACING_FULL_SPEED);
+    CHECK_EQ(stats.hides, 1u);
+    CHECK_EQ(stats.restores, 1u);
+    CHECK_EQ(stats.mismatches, 0u);
+    CHECK_EQ(r.sim.tray.failCount, 1u);
+    CHECK(!r.sim.tray.failAdds);
+    CHECK(r.core.hiddenWindows.empty());
+}
+
+TEST(OutcomeMismatchesAreCounted) {
+    REPLAY r;
+    // Recorded as hidden, but a shell class is always rejected
+    TRACE_REPLAY_STATS stats = ReplayTrace({ Event(TRACE_HOTKEY, 0x100, 1000, 1, L"Desktop", L"WorkerW") }, &r.core, &r.sim, PACING_FULL_SPEED);
+    CHECK_EQ(stats.hides, 0u);
+    CHECK_EQ(stats.mismatches, 1u);
+}
+
+TEST(HideBatchRefreshesOnce) {
+    REPLAY r;
+    std::vector<TRACE_EVENT> events;
+    for (uint32_t i = 0; i < 50; i++) events.push_back(Event(TRACE_HIDE, 0x1000 + i, 1000 + i, 1, L"W" + std::to_wstring(i), L"Notepad"));
+    events.push_back(DoubleClick(1010));
+    TRACE_REPLAY_STATS stats = ReplayTrace(events, &r.core, &r.sim, PACING_FULL_SPEED);
+    CHECK_EQ(stats.hides, 50u);
+    CHECK_EQ(stats.restores, 1u);
+    CHECK_EQ(r.sim.view.refreshCount, 2u); // The batch, then the restore
+    CHECK_EQ(r.sim.view.rows.size(), 49u);
+    CHECK(r.HiddenTitled(L"W10") == nullptr);
+}
+
+TEST(RecordedFileReplaysEndToEnd) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "traycaddy_test_trace.tctr";
+    {
+        TraceRecorder recorder;
+        CHECK(recorder.Open(path.wstring()));
+        recorder.Record(TRACE_HIDE, 0x500, 1000, 9, L"Restored at startup", L"Notepad");
+        recorder.Record(TRACE_WINDOW_CREATED, 0x600, 0, 10, L"Mail", L"Outlook");
+        recorder.Record(TRACE_WINDOW_TITLE, 0x600, 0, 10, L"Mail - Inbox (3)");
+        recorder.Record(TRACE_HOTKEY, 0x700, 0, 11, std::wstring(), L"Shell_TrayWnd");
+        recorder.Record(TRACE_HOTKEY, 0x600, 1001, 10, L"Mail - Inbox (3)", L"Outlook");
+        recorder.Record(TRACE_TASKBAR_CREATED);
+        recorder.Record(TRACE_TRAY_ICON, 0, 1000, TRACE_MOUSE_DBLCLK);
+        recorder.Record(TRACE_WINDOW_DESTROYED, 0x500);
+        recorder.Record(TRACE_COMMAND, 0, ID_MENU_RESTORE_ALL);
+    }
+
+    std::vector<TRACE_EVENT> events;
+    CHECK(LoadTrace(path.wstring(), &events));
+    std::filesystem::remove(path);
+    CHECK_EQ(events.size(), 9u);
+
+    REPLAY r;
+    TRACE_REPLAY_STATS stats = ReplayTrace(events, &r.core, &r.sim, PACING_FULL_SPEED);
+    CHECK_EQ(stats.events, 9u);
+    CHECK_EQ(stats.hides, 2u);
+    CHECK_EQ(stats.restores, 2u); // The double click, then restore all
+    CHECK_EQ(stats.mismatches, 0u);
+    CHECK(r.core.hiddenWindows.empty());
+    CHECK_EQ(r.sim.tray.Count(), 0u);
+    CHECK_EQ(r.sim.tray.addCount, 4u); // Two hides, then both re-added
+    CHECK_EQ(r.sim.windows.Count(), 2u); // Mail and the taskbar
+}
+
+TEST(ActionsReachTheFileBeforeClose) {
+    // A killed recorder never gets to Close; whatever was flushed is the trace
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "traycaddy_test_trace_tail.tctr";
+    std::vector<TRACE_EVENT> events;
+    {
+        TraceRecorder recorder;
+        CHECK(recorder.Open(path.wstring()));
+        CHECK(LoadTrace(path.wstring(), &events) && events.empty()); // Header only
+
+        recorder.Record(TRACE_WINDOW_CREATED, 0x600, 0, 10, L"Mail", L"Outlook");
+        recorder.Record(TRACE_TRAY_ICON, 0, 1000, 0x0200); // Mouse move
+        CHECK(LoadTrace(path.wstring(), &events) && events.empty()); // Still buffered
+
+        recorder.Record(TRACE_HOTKEY, 0x600, 1000, 10, L"Mail", L"Outlook");
+        CHECK(LoadTrace(path.wstring(), &events));
+        CHECK_EQ(events.size(), 3u);
+
+        recorder.Record(TRACE_RESTORE, 0, 1000);
+        CHECK(LoadTrace(path.wstring(), &events));
+        CHECK_EQ(events.size(), 4u);
+
+        recorder.Record(TRACE_WINDOW_TITLE, 0x600, 0, 10, L"Mail - Inbox");
+        recorder.Flush();
+        CHECK(LoadTrace(path.wstring(), &events));
+        CHECK_EQ(events.size(), 5u);
+    }
+    std::filesystem::remove(path);
+}
+
+int main() { return RunTests(); }